@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+
+"""
+Compares two Catch2 XML benchmark reports and flags regressions.
+
+Usage: python3 compare-benchmarks.py <BASELINE_XML> <CURRENT_XML> [THRESHOLD_PERCENT]
+Exits with 1 if any benchmark's mean got slower by more than the threshold (default 5%).
+"""
+
+import sys
+import xml.etree.ElementTree as ElementTree
+
+
+def load_means(path):
+    means = {}
+    for test_case in ElementTree.parse(path).getroot().iter("TestCase"):
+        for result in test_case.iter("BenchmarkResults"):
+            mean = result.find("mean")
+            if mean is not None:
+                name = test_case.get("name") + " / " + result.get("name")
+                means[name] = float(mean.get("value"))
+    return means
+
+
+def format_duration(nanoseconds):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if nanoseconds >= scale:
+            return "%.2f %s" % (nanoseconds / scale, unit)
+    return "%.1f ns" % nanoseconds
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__.strip())
+        return 2
+
+    baseline = load_means(sys.argv[1])
+    current = load_means(sys.argv[2])
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 5.0
+
+    regressions = 0
+    width = max((len(name) for name in current), default=0)
+
+    for name, mean in current.items():
+        if name not in baseline:
+            print("%-*s  %12s  %12s  (new)" % (width, name, "", format_duration(mean)))
+            continue
+
+        change = (mean - baseline[name]) / baseline[name] * 100.0
+        marker = ""
+        if change > threshold:
+            marker = "  REGRESSION"
+            regressions += 1
+        elif change < -threshold:
+            marker = "  improved"
+
+        print("%-*s  %12s  %12s  %+7.1f%%%s" % (width, name, format_duration(baseline[name]), format_duration(mean), change, marker))
+
+    for name in baseline:
+        if name not in current:
+            print("%-*s  (missing from current run)" % (width, name))
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+
+"""
+Finds where a server stops scaling. For every thread_pool_size, starts the server locally
+with a generated config, drives it with the load generator at each connection count and
+records throughput and latency percentiles for every step in a CSV file.
+
+Usage:
+  python3 scalability-sweep.py <BUILD_DIR> <cache-server|realtime-server|config-server> [options]
+
+Example:
+  python3 scalability-sweep.py build cache-server --threads 1,2,4,8 --connections 1,4,16,64 \\
+      --target "GET /flights?origin=SOF&destination=LON" --output sweep.csv
+
+Any config.ini key can be overridden with --set, e.g. --set storage.backend=memory to take
+the database out of the picture, or --set mysql.host=127.0.0.1 for a local MySQL.
+"""
+
+import argparse
+import csv
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+CSV_COLUMNS = [
+    "server", "thread_pool_size", "connections", "mode", "rate",
+    "requests", "throughput_rps", "p50_us", "p90_us", "p99_us", "p999_us", "max_us", "mean_us",
+    "non_2xx", "failures", "dropped",
+]
+
+DEFAULT_TARGETS = {
+    "cache-server": "GET /flights?origin=SOF&destination=LON",
+    "realtime-server": "GET /flights?origin=SOF&destination=LON",
+    "config-server": "GET /config/pairs/safe",
+}
+
+
+def parse_list(value):
+    return [int(item) for item in value.split(",") if item]
+
+
+def read_ini(path):
+    sections = {}
+    current = None
+    with open(path) as file:
+        for line in file:
+            line = line.strip()
+            if not line or line.startswith(("#", ";")):
+                continue
+            if line.startswith("[") and line.endswith("]"):
+                current = sections.setdefault(line[1:-1], {})
+            elif "=" in line and current is not None:
+                key, value = line.split("=", 1)
+                current[key.strip()] = value.strip()
+    return sections
+
+
+def write_ini(path, sections):
+    with open(path, "w") as file:
+        for name, values in sections.items():
+            file.write("[%s]\n" % name)
+            for key, value in values.items():
+                file.write("%s=%s\n" % (key, value))
+            file.write("\n")
+
+
+def set_option(sections, dotted, value):
+    section, key = dotted.split(".", 1)
+    sections.setdefault(section, {})[key] = value
+
+
+def wait_for_port(host, port, process, timeout):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        if process.poll() is not None:
+            return False
+        try:
+            with socket.create_connection((host, port), timeout=0.5):
+                return True
+        except OSError:
+            time.sleep(0.2)
+    return False
+
+
+def run_step(args, server, host, port, connections):
+    with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as report:
+        report_path = report.name
+
+    command = [
+        args.load_generator,
+        "--host", host,
+        "--port", str(port),
+        "--connections", str(connections),
+        "--threads", str(min(connections, args.client_threads)),
+        "--duration", str(args.duration),
+        "--warmup", str(args.warmup),
+        "--mode", args.mode,
+        "--rate", str(args.rate),
+        "--json", report_path,
+    ]
+    if server == "config-server":
+        command.append("--https")
+    if args.user:
+        command += ["--user", args.user]
+    for target in args.target or [DEFAULT_TARGETS[server]]:
+        command += ["--target", target]
+
+    try:
+        subprocess.run(command, check=True, stdout=subprocess.DEVNULL)
+        with open(report_path) as file:
+            return json.load(file)
+    finally:
+        os.unlink(report_path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("build_dir")
+    parser.add_argument("server", choices=sorted(DEFAULT_TARGETS))
+    parser.add_argument("--threads", type=parse_list, default=[1, 2, 4, 8], help="thread_pool_size values, comma-separated")
+    parser.add_argument("--connections", type=parse_list, default=[1, 2, 4, 8, 16, 32, 64], help="connection counts, comma-separated")
+    parser.add_argument("--target", action="append", help="load generator target, may be repeated")
+    parser.add_argument("--user", default="AirBaltic:password1", help="Basic auth credentials")
+    parser.add_argument("--mode", choices=["closed", "open"], default="closed")
+    parser.add_argument("--rate", type=float, default=100.0, help="requests per second in open mode")
+    parser.add_argument("--duration", type=int, default=10, help="measured seconds per step")
+    parser.add_argument("--warmup", type=int, default=2, help="unmeasured seconds before each step")
+    parser.add_argument("--client-threads", type=int, default=4, help="load generator threads")
+    parser.add_argument("--port", type=int, help="defaults to the port in the server's config.ini")
+    parser.add_argument("--set", action="append", default=[], metavar="SECTION.KEY=VALUE", help="override a config.ini value")
+    parser.add_argument("--load-generator", help="defaults to <BUILD_DIR>/load-generator/bin/load-generator")
+    parser.add_argument("--output", default="scalability-sweep.csv")
+    args = parser.parse_args()
+
+    bin_dir = os.path.join(args.build_dir, args.server, "bin")
+    server_bin = os.path.join(bin_dir, "server")
+    args.load_generator = args.load_generator or os.path.join(args.build_dir, "load-generator", "bin", "load-generator")
+
+    for path in (server_bin, args.load_generator):
+        if not os.access(path, os.X_OK):
+            print("Error: %s not found. Build it first." % path)
+            return 1
+
+    sections = read_ini(os.path.join(bin_dir, "config.ini"))
+    host = sections["global"].get("host", "127.0.0.1")
+    port = args.port or int(sections["global"]["port"])
+    set_option(sections, "global.port", str(port))
+    set_option(sections, "logging.level", "warning")
+    for override in args.set:
+        key, value = override.split("=", 1)
+        set_option(sections, key, value)
+
+    rows = []
+    with open(args.output, "w", newline="") as output:
+        writer = csv.DictWriter(output, fieldnames=CSV_COLUMNS)
+        writer.writeheader()
+
+        for threads in args.threads:
+            set_option(sections, "global.thread_pool_size", str(threads))
+            config_path = os.path.join(bin_dir, "sweep-config.ini")
+            write_ini(config_path, sections)
+
+            log_path = os.path.join(bin_dir, "sweep-server-%d.log" % threads)
+            with open(log_path, "w") as log:
+                process = subprocess.Popen([server_bin, config_path], cwd=bin_dir, stdout=log, stderr=subprocess.STDOUT)
+
+            try:
+                if not wait_for_port(host, port, process, timeout=30):
+                    print("Error: %s did not start with thread_pool_size=%d, see %s" % (args.server, threads, log_path))
+                    return 1
+
+                for connections in args.connections:
+                    report = run_step(args, args.server, host, port, connections)
+                    total = report["total"]
+                    latency = total["latency_us"]
+                    row = {
+                        "server": args.server,
+                        "thread_pool_size": threads,
+                        "connections": connections,
+                        "mode": args.mode,
+                        "rate": args.rate if args.mode == "open" else "",
+                        "requests": total["requests"],
+                        "throughput_rps": round(total["throughput_rps"], 1),
+                        "p50_us": latency["p50"],
+                        "p90_us": latency["p90"],
+                        "p99_us": latency["p99"],
+                        "p999_us": latency["p999"],
+                        "max_us": latency["max"],
+                        "mean_us": round(latency["mean"], 1),
+                        "non_2xx": total["requests"] - total["successes"],
+                        "failures": total["failures"],
+                        "dropped": total["dropped"],
+                    }
+                    writer.writerow(row)
+                    output.flush()
+                    rows.append(row)
+
+                    print("threads=%-3d connections=%-4d %10.1f req/s  p50=%8.2fms  p99=%8.2fms  p99.9=%8.2fms" % (
+                        threads, connections, row["throughput_rps"],
+                        latency["p50"] / 1000.0, latency["p99"] / 1000.0, latency["p999"] / 1000.0))
+            finally:
+                process.terminate()
+                try:
+                    process.wait(timeout=10)
+                except subprocess.TimeoutExpired:
+                    process.kill()
+                    process.wait()
+                os.unlink(config_path)
+
+    print("Wrote %d steps to %s" % (len(rows), args.output))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
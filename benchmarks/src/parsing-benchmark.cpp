@@ -0,0 +1,66 @@
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "json-reader.h"
+#include "pair.h"
+#include "schema-registry.h"
+#include "user.h"
+
+using namespace Utils;
+
+namespace
+{
+    const std::string pairJson = R"({"origin": "RIX", "destination": "MLA", "type": 0, "fareCarrier": "BA"})";
+    const std::string userJson = R"({"username": "new-user", "password": "new-password", "type": 2})";
+    const std::string invalidUserJson = R"({"username": "new-owner", "password": "new-owner-password", "type": 4})";
+}
+
+TEST_CASE("Request body parsing", "[parse]")
+{
+    BENCHMARK("JsonDocument + parsePair")
+    {
+        const JsonDocument document(pairJson);
+        return parsePair(document.root());
+    };
+
+    BENCHMARK("JsonDocument + parseUser")
+    {
+        const JsonDocument document(userJson);
+        return parseUser(document.root());
+    };
+}
+
+TEST_CASE("Schema validation", "[parse]")
+{
+    const ConfigServer::SchemaRegistry schemas(BENCHMARK_SCHEMAS_DIR "pair-schema.json",
+                                               BENCHMARK_SCHEMAS_DIR "user-schema.json");
+
+    const JsonDocument pair(pairJson);
+    const JsonDocument user(userJson);
+    const JsonDocument invalidUser(invalidUserJson);
+
+    BENCHMARK("validate pair")
+    {
+        schemas.get(ConfigServer::SchemaType::Pair)->validate(pair.root());
+    };
+
+    BENCHMARK("validate user")
+    {
+        schemas.get(ConfigServer::SchemaType::User)->validate(user.root());
+    };
+
+    BENCHMARK("validate invalid user")
+    {
+        try
+        {
+            schemas.get(ConfigServer::SchemaType::User)->validate(invalidUser.root());
+            return false;
+        }
+        catch(const HttpBadRequest&)
+        {
+            return true;
+        }
+    };
+}
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "flight-wire.h"
+#include "price-calendar.h"
+#include "route-engine.h"
+
+using namespace Utils;
+
+namespace
+{
+    /**
+     * Random flights between airports named A0, A1, ..., departing within the given number of
+     * days from 2021-01-01 and taking one to twelve hours, like the realtime server's seed data.
+     */
+    std::vector<Flight> makeNetwork(size_t airports, size_t flights, int64_t days = 7)
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<size_t> airport(0, airports - 1);
+        std::uniform_int_distribution<int64_t> departure(0, days * 86400);
+        std::uniform_int_distribution<int64_t> duration(3600, 12 * 3600);
+        std::uniform_real_distribution<double> price(100.0, 1000.0);
+
+        const int64_t start = parseDateTime("2021-01-01 00:00:00");
+
+        std::vector<Flight> network;
+        network.reserve(flights);
+        while(network.size() < flights)
+        {
+            const size_t origin = airport(gen);
+            const size_t destination = airport(gen);
+            if(origin == destination)
+            {
+                continue;
+            }
+
+            const int64_t departs = start + departure(gen);
+            network.push_back(Flight {
+                .origin = "A" + std::to_string(origin),
+                .destination = "A" + std::to_string(destination),
+                .type = FlightType::OneWay,
+                .departureTime = formatDateTime(departs),
+                .arrivalTime = formatDateTime(departs + duration(gen)),
+                .fareCarrier = "FB",
+                .price = price(gen),
+                .currency = "USD",
+                .cabin = CabinType::Economy
+            });
+        }
+
+        return network;
+    }
+}
+
+TEST_CASE("Itinerary search", "[route]")
+{
+    const std::vector<Flight> network = makeNetwork(2000, 100000);
+    const RouteGraph graph(network);
+
+    RouteQuery query;
+    query.origin = "A1";
+    query.destination = "A2";
+
+    BENCHMARK("RouteGraph construction, 2000 airports, 100000 flights")
+    {
+        return RouteGraph(network).flightCount();
+    };
+
+    BENCHMARK("cheapest, up to 3 legs")
+    {
+        return graph.search(query).itineraries.size();
+    };
+
+    query.objective = RouteObjective::FewestStops;
+    BENCHMARK("fewest stops, up to 3 legs")
+    {
+        return graph.search(query).itineraries.size();
+    };
+
+    query.objective = RouteObjective::Cheapest;
+    query.maxLegs = 4;
+    BENCHMARK("cheapest, up to 4 legs")
+    {
+        return graph.search(query).itineraries.size();
+    };
+
+    const RouteSearchResult result = graph.search(query);
+    BENCHMARK("serialize 5 itineraries")
+    {
+        return graph.serialize(result);
+    };
+}
+
+TEST_CASE("Price calendar", "[route]")
+{
+    // 90 pairs with about 1100 flights each, 18 per day.
+    const std::vector<Flight> network = makeNetwork(10, 100000, 60);
+    const int64_t from = parseDate("2021-01-01");
+    const int64_t to = from + 59;
+
+    PriceCalendar calendar;
+    for(const Flight& flight : network)
+    {
+        calendar.add(flight);
+    }
+
+    std::vector<Flight> pairFlights;
+    std::copy_if(network.begin(), network.end(), std::back_inserter(pairFlights), [](const Flight& flight)
+    {
+        return flight.origin == "A1" && flight.destination == "A2";
+    });
+
+    BENCHMARK("min per day over the pair's flights, 60 days")
+    {
+        std::map<int64_t, long double> cheapest;
+        for(const Flight& flight : pairFlights)
+        {
+            const int64_t day = parseDateTime(flight.departureTime) / 86400;
+            if(day >= from && day <= to)
+            {
+                const auto [it, inserted] = cheapest.emplace(day, flight.price);
+                it->second = std::min(it->second, flight.price);
+            }
+        }
+        return cheapest.size();
+    };
+
+    BENCHMARK("PriceCalendar lookup, 60 days")
+    {
+        return calendar.lookup("A1", "A2", from, to).size();
+    };
+
+    BENCHMARK("PriceCalendar add")
+    {
+        calendar.add(network[0]);
+    };
+}
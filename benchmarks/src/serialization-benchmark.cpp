@@ -0,0 +1,337 @@
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "flight.h"
+#include "flight-rows.h"
+#include "flight-wire.h"
+#include "json-reader.h"
+#include "pair.h"
+#include "user.h"
+#include "json-writer.h"
+#include "compression.h"
+#include "currency.h"
+
+using namespace Utils;
+
+namespace
+{
+    /**
+     * The property_tree based serializer which JsonWriter replaced, kept as a reference point.
+     */
+    std::string legacySerialize(const Flight& flight)
+    {
+        boost::property_tree::ptree ptree;
+        std::ostringstream buf;
+
+        ptree.put("origin", flight.origin);
+        ptree.put("destination", flight.destination);
+        ptree.put("type", static_cast<int>(flight.type));
+        ptree.put("departureTime", flight.departureTime);
+        ptree.put("arrivalTime", flight.arrivalTime);
+        ptree.put("fareCarrier", flight.fareCarrier);
+        ptree.put("price", flight.price);
+        ptree.put("currency", flight.currency);
+        ptree.put("cabin", static_cast<int>(flight.cabin));
+
+        boost::property_tree::write_json(buf, ptree, false);
+
+        return buf.str();
+    }
+
+    std::vector<Flight> makeFlights(size_t count)
+    {
+        std::vector<Flight> flights;
+        flights.reserve(count);
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            flights.push_back(Flight {
+                .origin = "SOF",
+                .destination = "LON",
+                .type = i % 2 ? FlightType::Roundtrip : FlightType::OneWay,
+                .departureTime = "2021-01-01 00:00:00",
+                .arrivalTime = "2021-01-01 12:00:00",
+                .fareCarrier = "FB",
+                .price = 100.0 + static_cast<double>(i) * 0.37,
+                .currency = "USD",
+                .cabin = static_cast<CabinType>(i % 4)
+            });
+        }
+
+        return flights;
+    }
+
+    /**
+     * Stands in for sql::ResultSet so that row-to-JSON building can be measured without a
+     * database. Columns are looked up by name, as the connector does.
+     */
+    class FakeResultSet
+    {
+    public:
+        explicit FakeResultSet(const std::vector<Flight>& rows) : _rows(rows) {}
+
+        size_t rowsCount() const { return _rows.size(); }
+
+        bool next()
+        {
+            return ++_current < _rows.size();
+        }
+
+        std::string getString(std::string_view column) const
+        {
+            const Flight& row = _rows[_current];
+            if(column == "origin")          return row.origin;
+            if(column == "destination")     return row.destination;
+            if(column == "dep_datetime")    return row.departureTime;
+            if(column == "arr_datetime")    return row.arrivalTime;
+            if(column == "f_carrier")       return row.fareCarrier;
+            if(column == "currency")        return row.currency;
+            return "";
+        }
+
+        bool getBoolean(std::string_view /*column*/) const
+        {
+            return _rows[_current].type == FlightType::Roundtrip;
+        }
+
+        double getDouble(std::string_view /*column*/) const
+        {
+            return static_cast<double>(_rows[_current].price);
+        }
+
+        int getInt(std::string_view /*column*/) const
+        {
+            return static_cast<int>(_rows[_current].cabin);
+        }
+
+    private:
+        const std::vector<Flight>& _rows;
+        size_t _current = static_cast<size_t>(-1);
+    };
+}
+
+TEST_CASE("Flight serialization", "[serialize]")
+{
+    const Flight flight = makeFlights(1).front();
+
+    BENCHMARK("ptree write_json")
+    {
+        return legacySerialize(flight);
+    };
+
+    BENCHMARK("JsonWriter")
+    {
+        return flight.serialize();
+    };
+}
+
+TEST_CASE("Flight array serialization", "[serialize]")
+{
+    const std::vector<Flight> flights = makeFlights(1000);
+
+    BENCHMARK("ptree write_json, 1000 flights")
+    {
+        std::string resultStr = "[";
+        for(const auto& flight : flights)
+        {
+            if(resultStr.size() > 1)
+            {
+                resultStr += ",";
+            }
+            resultStr += legacySerialize(flight);
+        }
+        resultStr += "]";
+        return resultStr;
+    };
+
+    BENCHMARK("JsonWriter, 1000 flights")
+    {
+        return serializeArray(flights);
+    };
+
+    BENCHMARK("encodeFlights, 1000 flights")
+    {
+        return encodeFlights(flights);
+    };
+}
+
+TEST_CASE("Currency conversion", "[serialize]")
+{
+    // About what an origin-wide /flights query returns, in a mix of currencies.
+    std::vector<Flight> flights = makeFlights(20000);
+    for(size_t i = 0; i < flights.size(); i += 3)
+    {
+        flights[i].currency = "EUR";
+    }
+
+    ExchangeRates::instance().configure("USD:1,EUR:0.92,GBP:0.79,BGN:1.80");
+
+    std::vector<double> prices(flights.size());
+    std::vector<double> factors(flights.size(), 1.0 / 0.92);
+    for(size_t i = 0; i < flights.size(); ++i)
+    {
+        prices[i] = static_cast<double>(flights[i].price);
+    }
+
+    BENCHMARK("scalePricesScalar, 20000 prices")
+    {
+        std::vector<double> scaled = prices;
+        scalePricesScalar(scaled.data(), factors.data(), scaled.size());
+        return scaled;
+    };
+
+    BENCHMARK("scalePrices, 20000 prices")
+    {
+        std::vector<double> scaled = prices;
+        scalePrices(scaled.data(), factors.data(), scaled.size());
+        return scaled;
+    };
+
+    BENCHMARK("ExchangeRates::convert, 20000 flights")
+    {
+        std::vector<Flight> converted = flights;
+        ExchangeRates::instance().convert(converted, "GBP");
+        return converted.size();
+    };
+
+    // The copy the conversion works on, measured separately since the servers convert in place.
+    BENCHMARK("copy only, 20000 flights")
+    {
+        std::vector<Flight> converted = flights;
+        return converted.size();
+    };
+
+    BENCHMARK("JsonWriter, 20000 flights")
+    {
+        return serializeArray(flights);
+    };
+}
+
+TEST_CASE("Currency conversion kernels agree", "[serialize]")
+{
+    // An odd number of eighths times 100 ends in .5 exactly, so these round on a tie.
+    std::vector<double> prices = { 1.0, 2.0, 3.0, 5.0, 1.0, 7.0, 9.0, 1.0 };
+    std::vector<double> factors = { 0.125, 0.125, 0.375, 0.625, 0.875, 0.375, 0.125, 0.625 };
+
+    // Prices written with a half cent, which binary cannot hold exactly, so they round either way.
+    for(const double price : { 0.005, 1.005, 2.675, 0.145, 10.125, 1234.565, 99.995, 0.015 })
+    {
+        prices.push_back(price);
+        factors.push_back(1.0);
+        prices.push_back(price);
+        factors.push_back(0.92);
+    }
+
+    double tied[] = { 1.0, 3.0 };
+    const double eighths[] = { 0.125, 0.125 };
+    scalePricesScalar(tied, eighths, 2);
+    REQUIRE(tied[0] == 0.12);
+    REQUIRE(tied[1] == 0.38);
+
+    // Every length up to all of them, so the vector loop leaves each remainder from 0 to 3.
+    for(size_t count = 0; count <= prices.size(); ++count)
+    {
+        std::vector<double> vectorized(prices.begin(), prices.begin() + count);
+        std::vector<double> scalar = vectorized;
+        scalePrices(vectorized.data(), factors.data(), count);
+        scalePricesScalar(scalar.data(), factors.data(), count);
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            uint64_t vectorizedBits = 0;
+            uint64_t scalarBits = 0;
+            std::memcpy(&vectorizedBits, &vectorized[i], sizeof(double));
+            std::memcpy(&scalarBits, &scalar[i], sizeof(double));
+
+            INFO("count " << count << ", price " << prices[i] << " times " << factors[i]);
+            REQUIRE(vectorizedBits == scalarBits);
+        }
+    }
+}
+
+TEST_CASE("Flight array decoding", "[serialize]")
+{
+    const std::vector<Flight> flights = makeFlights(1000);
+    const std::string json = serializeArray(flights);
+    const std::string binary = encodeFlights(flights);
+
+    BENCHMARK("JsonDocument, 1000 flights")
+    {
+        const JsonDocument document(json);
+        double total = 0.0;
+        for(const auto& flight : document.root().as_array())
+        {
+            total += flight.as_object().at("price").to_number<double>();
+        }
+        return total;
+    };
+
+    BENCHMARK("FlightBatchView, 1000 flights")
+    {
+        const FlightBatchView batch(binary);
+        double total = 0.0;
+        for(size_t i = 0; i < batch.size(); ++i)
+        {
+            total += batch[i].price();
+        }
+        return total;
+    };
+}
+
+TEST_CASE("Pair and user serialization", "[serialize]")
+{
+    const Pair pair { .origin = "SOF", .destination = "LON", .type = true, .fareCarrier = "FB" };
+    const User user { .username = "BulgariaAir", .password = "password2", .type = UserType::External };
+
+    BENCHMARK("Pair")
+    {
+        return pair.serialize();
+    };
+
+    BENCHMARK("User")
+    {
+        return user.serialize();
+    };
+}
+
+TEST_CASE("Result set to JSON", "[serialize]")
+{
+    const std::vector<Flight> flights = makeFlights(1000);
+
+    BENCHMARK("readFlightRows + serializeArray, 1000 rows")
+    {
+        FakeResultSet result(flights);
+        return serializeArray(readFlightRows(result));
+    };
+}
+
+TEST_CASE("Response compression", "[serialize]")
+{
+    const std::string body = serializeArray(makeFlights(1000));
+    Compressor::instance().configure(6, 0, 16);
+
+    BENCHMARK("gzip level 1, 1000 flights")
+    {
+        return compress(body, ContentEncoding::Gzip, 1);
+    };
+
+    BENCHMARK("gzip level 6, 1000 flights")
+    {
+        return compress(body, ContentEncoding::Gzip, 6);
+    };
+
+    BENCHMARK("Compressor cache hit, 1000 flights")
+    {
+        return Compressor::instance().compress(body, ContentEncoding::Gzip);
+    };
+}
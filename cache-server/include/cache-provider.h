@@ -1,20 +1,65 @@
 #pragma once
 
-#include "mysql-provider.h"
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+
+#include "flight-wire.h"
+#include "price-calendar.h"
+#include "route-engine.h"
+#include "storage.h"
 
 namespace CacheServer
 {
-    class Provider final : public Utils::MySqlProvider
+    class Provider final : public Utils::StorageProvider
     {
     public:
-        explicit Provider(const std::string& dbHost,
-                          const int dbPort,
-                          const std::string& username,
-                          const std::string& password,
-                          const std::string& database);
+        explicit Provider(std::shared_ptr<Utils::Storage> storage);
+
+        /**
+         * @brief With a currency, every price is converted to it, see currency.h.
+         */
+        std::string getFlights(const std::string& origin, const std::string& destination,
+                               Utils::FlightFormat format = Utils::FlightFormat::Json, std::string_view currency = {});
 
-        std::string getFlights(const std::string& origin, const std::string& destination);
+        /**
+         * @brief Multi-leg itineraries between the query's airports, as JSON.
+         */
+        std::string getItineraries(const Utils::RouteQuery& query);
+
+        /**
+         * @brief The cheapest fare per day between fromDay and toDay, both included, as JSON.
+         */
+        std::string getCalendar(const std::string& origin, const std::string& destination, int64_t fromDay, int64_t toDay);
 
     private:
+        /**
+         * @brief The graph of all flights, rebuilt on first use after the flights table changes.
+         * Searches already running keep the graph they started with.
+         */
+        std::shared_ptr<const Utils::RouteGraph> routeGraph();
+
+        std::mutex _routeGraphMutex;
+        std::shared_ptr<const Utils::RouteGraph> _routeGraph;
+        uint64_t _routeGraphVersion = 0;
+
+        /**
+         * @brief Folds the flights inserted since the last call into the calendar, if the
+         * flights table changed at all, or rebuilds it if flights were changed otherwise.
+         */
+        void refreshCalendar();
+
+        /**
+         * @brief Adds the flights after _calendarLastFlightId to the calendar and returns
+         * how many there were.
+         */
+        size_t foldNewFlights();
+
+        std::shared_mutex _calendarMutex;
+        Utils::PriceCalendar _calendar;
+        std::optional<uint64_t> _calendarVersion; // of the flights table when last refreshed
+        uint64_t _calendarLastFlightId = 0;
     };
-}
\ No newline at end of file
+}
@@ -1,98 +1,178 @@
 #include "cache-provider.h"
 
-#include <mysql_connection.h>
-#include <mysql_driver.h>
-#include <cppconn/resultset.h>
-#include <cppconn/statement.h>
-#include <cppconn/prepared_statement.h>
-
-#include "flight.h"
-#include "pointer-wrapper.h"
+#include "currency.h"
+#include "flight-wire.h"
+#include "json-writer.h"
+#include "logger.h"
+#include "tracing.h"
 
 namespace CacheServer
 {
-    Provider::Provider(const std::string& dbHost,
-                       const int dbPort,
-                       const std::string& username,
-                       const std::string& password,
-                       const std::string& database)
-        : Utils::MySqlProvider(dbHost, dbPort, username, password, database) {}
-
-    std::string Provider::getFlights(const std::string& origin, const std::string& destination)
+    namespace
+    {
+        constexpr size_t calendarPageSize = 1000;
+    }
+
+    Provider::Provider(std::shared_ptr<Utils::Storage> storage)
+        : Utils::StorageProvider(std::move(storage)) {}
+
+    std::string Provider::getFlights(const std::string& origin, const std::string& destination, Utils::FlightFormat format,
+                                     std::string_view currency)
     {
-        const bool setOrigin = !origin.empty();
-        const bool setDestination = !destination.empty();
-
-        std::string queryStr = "SELECT p.origin AS origin, "
-                                        "p.destination AS destination, "
-                                        "p.type AS type, "
-                                        "p.f_carrier AS f_carrier, "
-                                        "f.dep_datetime AS dep_datetime, "
-                                        "f.arr_datetime AS arr_datetime, "
-                                        "f.price AS price, "
-                                        "f.currency AS currency, "
-                                        "f.cabin AS cabin "
-                                "FROM flights f JOIN pairs p ON f.pair_id = p.id";
-
-        if(setOrigin || setDestination)
+        auto flights = _storage->getFlights(origin, destination);
+
+        if(!currency.empty())
         {
-            queryStr += " WHERE ";
+            TRACE_SPAN("convertCurrency");
+            try
+            {
+                Utils::ExchangeRates::instance().convert(flights, currency);
+            }
+            catch(const std::invalid_argument& e)
+            {
+                throw Utils::HttpInternalServerError(e.what());
+            }
+        }
 
-            if(setOrigin)
+        TRACE_SPAN("serializeFlights");
+        if(format == Utils::FlightFormat::Binary)
+        {
+            try
             {
-                queryStr += "origin='" + origin + "'";
-                if(setDestination)
-                {
-                    queryStr += " AND ";
-                }
+                return Utils::encodeFlights(flights);
+            }
+            catch(const std::invalid_argument& e)
+            {
+                throw Utils::HttpInternalServerError(e.what());
+            }
+        }
+
+        return Utils::serializeArray(flights);
+    }
+
+    std::string Provider::getItineraries(const Utils::RouteQuery& query)
+    {
+        const auto graph = routeGraph();
+
+        TRACE_SPAN("searchItineraries");
+        return graph->serialize(graph->search(query));
+    }
+
+    std::shared_ptr<const Utils::RouteGraph> Provider::routeGraph()
+    {
+        const uint64_t version = _storage->getTableVersion(Utils::Table::Flights);
+
+        std::lock_guard<std::mutex> lock(_routeGraphMutex);
+        if(!_routeGraph || _routeGraphVersion != version)
+        {
+            TRACE_SPAN("buildRouteGraph");
+            try
+            {
+                _routeGraph = std::make_shared<const Utils::RouteGraph>(_storage->getFlights("", ""));
             }
+            catch(const std::invalid_argument& e)
+            {
+                throw Utils::HttpInternalServerError(e.what());
+            }
+            _routeGraphVersion = version;
+        }
+
+        return _routeGraph;
+    }
+
+    std::string Provider::getCalendar(const std::string& origin, const std::string& destination, int64_t fromDay, int64_t toDay)
+    {
+        refreshCalendar();
+
+        std::shared_lock<std::shared_mutex> lock(_calendarMutex);
+        const std::vector<Utils::CalendarDay> days = _calendar.lookup(origin, destination, fromDay, toDay);
 
-            if(setDestination)
+        TRACE_SPAN("serializeCalendar");
+        std::string out;
+        out.reserve(128 + days.size() * 80);
+
+        Utils::JsonWriter writer(out);
+        writer.beginObject();
+        writer.field("origin", origin);
+        writer.field("destination", destination);
+        writer.field("from", Utils::formatDate(fromDay));
+        writer.field("to", Utils::formatDate(toDay));
+        writer.key("days");
+        writer.beginArray();
+        for(const Utils::CalendarDay& day : days)
+        {
+            writer.beginObject();
+            writer.field("date", Utils::formatDate(day.day));
+            writer.field("price", static_cast<double>(day.priceTicks) / Utils::flightPriceScale);
+            writer.field("currency", day.currency);
+            writer.field("flights", day.flights);
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+
+        return out;
+    }
+
+    void Provider::refreshCalendar()
+    {
+        const uint64_t version = _storage->getTableVersion(Utils::Table::Flights);
+        {
+            std::shared_lock<std::shared_mutex> lock(_calendarMutex);
+            if(_calendarVersion == version)
             {
-                queryStr += "destination='" + destination + "'";
+                return;
             }
         }
 
-        queryStr += ";";
+        std::unique_lock<std::shared_mutex> lock(_calendarMutex);
+        if(_calendarVersion == version)
+        {
+            return;
+        }
+
+        TRACE_SPAN("refreshCalendar");
+        const size_t folded = foldNewFlights();
+
+        // The version grows by one per changed row. If it moved by more than the rows just
+        // folded in, flights were updated or deleted, or one committed behind an id already
+        // seen, and only a rebuild picks those up. A version that went back means the table
+        // was recreated.
+        if(_calendarVersion && (version < *_calendarVersion || version - *_calendarVersion > folded))
+        {
+            TRACE_SPAN("rebuildCalendar");
+            _calendar = Utils::PriceCalendar();
+            _calendarLastFlightId = 0;
+            foldNewFlights();
+        }
 
-        std::cout << "[DEBUG] Executing query " << queryStr << std::endl;
+        // Flights inserted after the version was read are picked up by the next refresh.
+        _calendarVersion = version;
+    }
 
-        try
+    size_t Provider::foldNewFlights()
+    {
+        size_t folded = 0;
+        Utils::Page<Utils::Flight> page;
+        do
         {
-            auto stmt = createStatement();
-            auto result = Utils::PointerWrapper(stmt->executeQuery(queryStr));
-    
-            std::string resultStr = "[";
-    
-            while(result->next())
+            page = _storage->getFlightsPage(_calendarLastFlightId, calendarPageSize);
+            for(const Utils::Flight& flight : page.records)
             {
-                if(resultStr.size() > 1)
+                try
+                {
+                    _calendar.add(flight);
+                }
+                catch(const std::invalid_argument& e)
                 {
-                    resultStr += ",";
+                    LOG_WARNING("Leaving a flight out of the price calendar: ", e.what());
                 }
-    
-                Utils::Flight flight {
-                    .origin = result->getString("origin"),
-                    .destination = result->getString("destination"),
-                    .type = result->getBoolean("type") ? Utils::FlightType::Roundtrip : Utils::FlightType::OneWay,
-                    .departureTime = result->getString("dep_datetime"),
-                    .arrivalTime = result->getString("arr_datetime"),
-                    .fareCarrier = result->getString("f_carrier"),
-                    .price = result->getDouble("price"),
-                    .currency = result->getString("currency"),
-                    .cabin = static_cast<Utils::CabinType>(result->getInt("cabin"))
-                };
-    
-                resultStr += flight.serialize();
             }
-    
-            resultStr += "]";
-    
-            return resultStr;
-        }
-        catch(const std::exception& e)
-        {
-            throw Utils::HttpInternalServerError(e.what());
+            _calendarLastFlightId = page.lastId;
+            folded += page.records.size();
         }
+        while(page.hasMore);
+
+        return folded;
     }
-}
\ No newline at end of file
+}
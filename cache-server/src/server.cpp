@@ -3,6 +3,9 @@
 #include <thread>
 
 #include "server-common.h"
+#include "reuse-port-server.h"
+#include "filtering-server.h"
+#include "unix-socket-server.h"
 #include "cache-provider.h"
 
 using HttpServer = SimpleWeb::Server<SimpleWeb::HTTP>;
@@ -14,13 +17,13 @@ const std::set<std::string> BLACKLISTED_IPS = {
     "127.0.0.1"
 };
 
-void addResources(HttpServer& server, std::shared_ptr<CacheServer::Provider> provider, const std::set<std::string>& blacklistedIPs)
+void addResources(HttpServer& server, std::shared_ptr<CacheServer::Provider> provider)
 {
-    server.default_resource["GET"] = [blacklistedIPs](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+    addDefaultResource(server, "GET", [](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
     {
         try
         {
-            validateNotBlacklisted(request, blacklistedIPs);
+            validateNotBlacklisted(request);
         }
         catch(const HttpException& e)
         {
@@ -30,26 +33,27 @@ void addResources(HttpServer& server, std::shared_ptr<CacheServer::Provider> pro
 
         try
         {
-            response->write("This is the default resource. Try: /flights?origin=origin&destination=destination\n");
+            response->write("This is the default resource. Try: /flights?origin=origin&destination=destination or /itineraries?origin=origin&destination=destination\n");
         }
         catch(const std::exception& e)
         {
             response->write(SimpleWeb::StatusCode::server_error_internal_server_error, std::string("Unexpected error: ") + e.what());
         }
-    };
+    });
 
-    server.resource["^/flights$"]["GET"] = [provider, blacklistedIPs](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+    addResource(server, "^/flights$", "GET", [provider](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
     {
         try
         {
-            validateNotBlacklisted(request, blacklistedIPs);
+            validateNotBlacklisted(request);
 
             verifyHeaders(request->header);
-			auto [username, password] = parseBasicAuthCredentials(request->header);
+			const BasicCredentials credentials = parseBasicAuthCredentials(request->header);
+			const std::string_view username = credentials.username();
 
-            if(!provider->isAuthenticated(username, password))
+            if(!provider->isAuthenticated(username, credentials.password()))
             {
-                std::cout << "[DEBUG] Authentication failed for user: " << username << " password: " << password << std::endl;
+                LOG_DEBUG("Authentication failed for user: ", username, " password: ", credentials.password());
                 throw HttpUnauthorized("Invalid username or password.");
             }
 
@@ -58,68 +62,231 @@ void addResources(HttpServer& server, std::shared_ptr<CacheServer::Provider> pro
                !provider->isAuthorized(username, UserType::Manager) &&
                !provider->isAuthorized(username, UserType::Admin))
             {
-                throw HttpForbidden("User " + username + " is not authorized to perform this action.");
+                throw HttpForbidden("User " + std::string(username) + " is not authorized to perform this action.");
             }
 
-            const auto queriesMap = request->parse_query_string();
+            // Airport codes fit std::string's inline storage, so none of this allocates.
+            char originBuffer[64];
+            char destinationBuffer[64];
+            const std::string origin(queryParameter(request->query_string, "origin", originBuffer));
+            const std::string destination(queryParameter(request->query_string, "destination", destinationBuffer));
 
-            std::string origin = "";
-            std::string destination = "";
+            char currencyBuffer[16];
+            const std::string_view currency = requestedCurrency(request->query_string, currencyBuffer);
 
-            const auto originIt = queriesMap.find("origin");
-            if(originIt != queriesMap.end())
+            // Internal consumers can ask for the binary format, see flight-wire.h.
+            const FlightFormat format = requestedFlightFormat(*request);
+            std::string versionTag = provider->versionTag({ Table::Flights, Table::Pairs }) +
+                                     (format == FlightFormat::Binary ? "-binary" : "");
+            if(!currency.empty())
             {
-                origin = originIt->second;
+                versionTag += '-';
+                versionTag += currency;
             }
 
-            const auto destinationIt = queriesMap.find("destination");
-            if(destinationIt != queriesMap.end())
+            writeVersioned(*response, *request, versionTag, [&]()
             {
-                destination = destinationIt->second;
+                return provider->getFlights(origin, destination, format, currency);
+            }, flightResponseHeaders(format));
+        }
+        catch(const HttpException& e)
+        {
+            response->write(extractErrorCode(e), e.what());
+        }
+    });
+
+    addResource(server, "^/flights/calendar$", "GET", [provider](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+    {
+        try
+        {
+            validateNotBlacklisted(request);
+
+            verifyHeaders(request->header);
+            const BasicCredentials credentials = parseBasicAuthCredentials(request->header);
+            const std::string_view username = credentials.username();
+
+            if(!provider->isAuthenticated(username, credentials.password()))
+            {
+                LOG_DEBUG("Authentication failed for user: ", username, " password: ", credentials.password());
+                throw HttpUnauthorized("Invalid username or password.");
+            }
+
+            if(!provider->isAuthorized(username, UserType::External) &&
+               !provider->isAuthorized(username, UserType::Internal) &&
+               !provider->isAuthorized(username, UserType::Manager) &&
+               !provider->isAuthorized(username, UserType::Admin))
+            {
+                throw HttpForbidden("User " + std::string(username) + " is not authorized to perform this action.");
             }
 
-            response->write(provider->getFlights(origin, destination));
+            char originBuffer[64];
+            char destinationBuffer[64];
+            char fromBuffer[16];
+            char toBuffer[16];
+            const std::string origin(queryParameter(request->query_string, "origin", originBuffer));
+            const std::string destination(queryParameter(request->query_string, "destination", destinationBuffer));
+            if(origin.empty() || destination.empty())
+            {
+                throw HttpBadRequest("origin and destination are required.");
+            }
+
+            int64_t fromDay = 0;
+            int64_t toDay = 0;
+            try
+            {
+                fromDay = parseDate(queryParameter(request->query_string, "from", fromBuffer));
+                toDay = parseDate(queryParameter(request->query_string, "to", toBuffer));
+            }
+            catch(const std::invalid_argument&)
+            {
+                throw HttpBadRequest("from and to must be dates in YYYY-MM-DD format.");
+            }
+
+            if(toDay < fromDay || toDay - fromDay >= 366)
+            {
+                throw HttpBadRequest("to must be on or after from, and at most a year later.");
+            }
+
+            writeVersioned(*response, *request, provider->versionTag({ Table::Flights }), [&]()
+            {
+                return provider->getCalendar(origin, destination, fromDay, toDay);
+            });
         }
         catch(const HttpException& e)
         {
             response->write(extractErrorCode(e), e.what());
         }
-    };
+    });
+
+    addResource(server, "^/itineraries$", "GET", [provider](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+    {
+        try
+        {
+            validateNotBlacklisted(request);
+
+            verifyHeaders(request->header);
+            const BasicCredentials credentials = parseBasicAuthCredentials(request->header);
+            const std::string_view username = credentials.username();
+
+            if(!provider->isAuthenticated(username, credentials.password()))
+            {
+                LOG_DEBUG("Authentication failed for user: ", username, " password: ", credentials.password());
+                throw HttpUnauthorized("Invalid username or password.");
+            }
+
+            if(!provider->isAuthorized(username, UserType::External) &&
+               !provider->isAuthorized(username, UserType::Internal) &&
+               !provider->isAuthorized(username, UserType::Manager) &&
+               !provider->isAuthorized(username, UserType::Admin))
+            {
+                throw HttpForbidden("User " + std::string(username) + " is not authorized to perform this action.");
+            }
+
+            char originBuffer[64];
+            char destinationBuffer[64];
+            char sortBuffer[16];
+
+            RouteQuery query;
+            query.origin = queryParameter(request->query_string, "origin", originBuffer);
+            query.destination = queryParameter(request->query_string, "destination", destinationBuffer);
+            if(query.origin.empty() || query.destination.empty() || query.origin == query.destination)
+            {
+                throw HttpBadRequest("origin and destination must be two different airports.");
+            }
+
+            // Every extra leg multiplies the search space, so they are capped well below what
+            // the search could technically handle.
+            const uint64_t maxLegs = unsignedQueryParameter(request->query_string, "max_legs", query.maxLegs);
+            if(maxLegs < 1 || maxLegs > 4)
+            {
+                throw HttpBadRequest("max_legs must be between 1 and 4.");
+            }
+            query.maxLegs = static_cast<unsigned int>(maxLegs);
+
+            const uint64_t minConnection = unsignedQueryParameter(request->query_string, "min_connection", query.minConnectionSeconds / 60);
+            if(minConnection > 24 * 60)
+            {
+                throw HttpBadRequest("min_connection must be at most 1440 minutes.");
+            }
+            query.minConnectionSeconds = static_cast<int64_t>(minConnection) * 60;
+
+            const std::string_view sort = queryParameter(request->query_string, "sort", sortBuffer);
+            if(sort == "fewest_stops")
+            {
+                query.objective = RouteObjective::FewestStops;
+            }
+            else if(!sort.empty() && sort != "cheapest")
+            {
+                throw HttpBadRequest("sort must be cheapest or fewest_stops.");
+            }
+
+            query.limit = unsignedQueryParameter(request->query_string, "limit", query.limit);
+            if(query.limit < 1 || query.limit > 50)
+            {
+                throw HttpBadRequest("limit must be between 1 and 50.");
+            }
+
+            writeVersioned(*response, *request, provider->versionTag({ Table::Flights }), [&]()
+            {
+                return provider->getItineraries(query);
+            });
+        }
+        catch(const HttpException& e)
+        {
+            response->write(extractErrorCode(e), e.what());
+        }
+    });
+
+    addIpFilterResource(server, provider);
+    addMetricsResource(server);
+    addTraceResource(server);
 }
 
-int main(int /*argc*/, char **argv)
+int main(int argc, char **argv)
 {
     try
     {
         const auto execPathWithFilename = std::string(argv[0]);
 		const auto execPath = execPathWithFilename.substr(0, execPathWithFilename.size() - strlen(executableName));
-		const auto configPath = execPath + "config.ini";
+		const auto configPath = argc > 1 ? std::string(argv[1]) : execPath + "config.ini";
 
 		std::cout << "Parsing " << configPath << "..." << std::endl;
 
         Options options(configPath);
+        startAffinity(options);
+        startLogging(options);
+        startTracing(options);
+        startCompression(options);
+        startIpFilter(options);
+        startCurrency(options);
 
 		std::cout << "Done." << std::endl;
 
-        auto provider = std::make_shared<CacheServer::Provider>(options.getMySqlHost(),
-                                                                options.getMySqlPort(),
-                                                                options.getMySqlUsername(),
-                                                                options.getMySqlPassword(),
-                                                                options.getMySqlDatabase());
+        auto provider = std::make_shared<CacheServer::Provider>(createStorage(options));
+        if(options.getStorageBackend() == "memory")
+        {
+            // In-memory tables are per process, so nobody else seeds this server's flights.
+            // With MySQL the realtime server does it.
+            provider->populateFlightsTable();
+        }
 
-        HttpServer server;
+        auto servers = createServers(options, [&]()
+        {
+            auto server = std::make_unique<ReusePortServer<UnixSocketServer<FilteringHttpServer>>>();
+            configure(*server, options);
+            addResources(*server, provider);
+            return server;
+        });
 
-        configure(server, options);
-        addResources(server, provider, options.getBlacklistedIPs());
-        
-        std::thread serverThread([&server]()
+        std::thread serverThread([&servers]()
         {
-            server.start();
+            runServers(servers);
         });
 
-        std::cout << "Server started on port " << server.config.port << "..." << std::endl;
+        std::cout << "Server started on port " << options.getPort() << "..." << std::endl;
         
         serverThread.join();
+        Logger::instance().stop();
 
         return 0;
     }
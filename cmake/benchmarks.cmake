@@ -0,0 +1,40 @@
+add_executable(benchmarks
+    benchmarks/src/serialization-benchmark.cpp
+    benchmarks/src/parsing-benchmark.cpp
+    benchmarks/src/request-benchmark.cpp
+    benchmarks/src/route-benchmark.cpp
+    config-server/src/schema-registry.cpp
+    utils/src/options.cpp
+    utils/src/logger.cpp
+    utils/src/affinity.cpp
+    utils/src/ip-filter.cpp
+    utils/src/currency.cpp
+    utils/src/flight-wire.cpp
+    utils/src/route-engine.cpp
+    utils/src/price-calendar.cpp
+    utils/src/tracing.cpp
+    utils/src/compression.cpp
+)
+
+target_include_directories(benchmarks PRIVATE
+    config-server/include
+)
+
+target_compile_definitions(benchmarks PRIVATE
+    BENCHMARK_SCHEMAS_DIR="${CMAKE_SOURCE_DIR}/config-server/schemas/"
+)
+
+set(BIN_DIR ${CMAKE_BINARY_DIR}/benchmarks/bin)
+
+file(MAKE_DIRECTORY ${BIN_DIR})
+
+set_target_properties(benchmarks
+    PROPERTIES
+    RUNTIME_OUTPUT_DIRECTORY ${BIN_DIR})
+
+target_link_libraries(benchmarks
+    simple-web-server
+    ZLIB::ZLIB
+    ValiJSON::valijson
+    Catch2::Catch2WithMain
+)
@@ -6,7 +6,19 @@ add_executable(cacheserver
     cache-server/src/server.cpp
     cache-server/src/cache-provider.cpp
     utils/src/options.cpp
+    utils/src/storage.cpp
     utils/src/mysql-provider.cpp
+    utils/src/in-memory-storage.cpp
+    utils/src/logger.cpp
+    utils/src/affinity.cpp
+    utils/src/ip-filter.cpp
+    utils/src/currency.cpp
+    utils/src/flight-wire.cpp
+    utils/src/route-engine.cpp
+    utils/src/price-calendar.cpp
+    utils/src/metrics.cpp
+    utils/src/tracing.cpp
+    utils/src/compression.cpp
 )
 
 set(BIN_DIR ${CMAKE_BINARY_DIR}/cache-server/bin)
@@ -20,6 +32,7 @@ set_target_properties(cacheserver
 
 target_link_libraries(cacheserver
     simple-web-server
+    ZLIB::ZLIB
     mysqlcppconn
 )
 
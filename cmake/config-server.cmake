@@ -5,8 +5,22 @@ include_directories(
 add_executable(configserver
     config-server/src/server.cpp
     config-server/src/config-provider.cpp
+    config-server/src/change-log.cpp
+    config-server/src/schema-registry.cpp
+    config-server/src/record-reader.cpp
+    config-server/src/tls-server.cpp
     utils/src/options.cpp
+    utils/src/storage.cpp
     utils/src/mysql-provider.cpp
+    utils/src/in-memory-storage.cpp
+    utils/src/logger.cpp
+    utils/src/affinity.cpp
+    utils/src/ip-filter.cpp
+    utils/src/currency.cpp
+    utils/src/flight-wire.cpp
+    utils/src/metrics.cpp
+    utils/src/tracing.cpp
+    utils/src/compression.cpp
 )
 
 set(BIN_DIR ${CMAKE_BINARY_DIR}/config-server/bin)
@@ -20,6 +34,7 @@ set_target_properties(configserver
 
 target_link_libraries(configserver
     simple-web-server
+    ZLIB::ZLIB
     mysqlcppconn
     ValiJSON::valijson
 )
@@ -0,0 +1,24 @@
+add_executable(loadgenerator
+    load-generator/src/main.cpp
+    load-generator/src/load-generator.cpp
+    load-generator/src/report.cpp
+    load-generator/src/https-client.cpp
+    load-generator/src/unix-client.cpp
+)
+
+target_include_directories(loadgenerator PRIVATE
+    load-generator/include
+)
+
+set(BIN_DIR ${CMAKE_BINARY_DIR}/load-generator/bin)
+
+file(MAKE_DIRECTORY ${BIN_DIR})
+
+set_target_properties(loadgenerator
+    PROPERTIES
+    RUNTIME_OUTPUT_NAME load-generator
+    RUNTIME_OUTPUT_DIRECTORY ${BIN_DIR})
+
+target_link_libraries(loadgenerator
+    simple-web-server
+)
@@ -6,7 +6,17 @@ add_executable(realtimeserver
     realtime-server/src/server.cpp
     realtime-server/src/flights-provider.cpp
     utils/src/options.cpp
+    utils/src/storage.cpp
     utils/src/mysql-provider.cpp
+    utils/src/in-memory-storage.cpp
+    utils/src/logger.cpp
+    utils/src/affinity.cpp
+    utils/src/ip-filter.cpp
+    utils/src/currency.cpp
+    utils/src/flight-wire.cpp
+    utils/src/metrics.cpp
+    utils/src/tracing.cpp
+    utils/src/compression.cpp
 )
 
 set(BIN_DIR ${CMAKE_BINARY_DIR}/realtime-server/bin)
@@ -20,6 +30,7 @@ set_target_properties(realtimeserver
 
 target_link_libraries(realtimeserver
     simple-web-server
+    ZLIB::ZLIB
     mysqlcppconn
 )
 
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "storage.h"
+
+namespace ConfigServer
+{
+    struct Change
+    {
+        uint64_t version;
+        Utils::Table table;
+        std::string record; // the serialized user or pair
+    };
+
+    /**
+     * A bounded, in-memory log of the user and pair insertions made through this server, so
+     * that mirrors can follow GET /config/changes instead of re-reading whole tables.
+     *
+     * Versions increase by one per change. The first version is derived from the wall clock
+     * at startup, so a version handed out before a restart is never mistaken for one of the
+     * new log: it reads as trimmed and the consumer is told to resynchronize.
+     */
+    class ChangeLog
+    {
+    public:
+        using Listener = std::function<void()>;
+
+        explicit ChangeLog(size_t capacity);
+
+        ChangeLog(const ChangeLog&) = delete;
+        ChangeLog& operator=(const ChangeLog&) = delete;
+
+        uint64_t version() const;
+
+        /**
+         * @brief Records a change, dropping the oldest one if the log is full, and notifies
+         * every listener. Listeners run on the calling thread, after the lock is released.
+         */
+        void append(Utils::Table table, std::string record);
+
+        /**
+         * @brief Copies up to limit changes newer than since into out and returns the version
+         * the consumer has seen after them. Throws HttpGone if changes after since were
+         * already trimmed, or since is from before a restart.
+         */
+        uint64_t collect(uint64_t since, size_t limit, std::vector<Change>& out) const;
+
+        /**
+         * @brief Calls listener once, on the next append. Returns 0 without subscribing if
+         * there already are changes newer than since, otherwise an id for unsubscribe().
+         */
+        uint64_t subscribe(uint64_t since, Listener listener);
+
+        /**
+         * @brief Does nothing if the listener has already been called.
+         */
+        void unsubscribe(uint64_t id);
+
+    private:
+        const size_t _capacity;
+
+        mutable std::mutex _mutex;
+        std::deque<Change> _changes;
+        uint64_t _version;
+        uint64_t _trimmedThrough; // changes up to this version are no longer available
+
+        std::map<uint64_t, Listener> _listeners;
+        uint64_t _nextListenerId = 1;
+    };
+
+    /**
+     * @brief {"version":V,"changes":[{"version":..,"table":"pairs","record":{..}},..]}
+     */
+    std::string serializeChanges(uint64_t version, const std::vector<Change>& changes);
+}
@@ -1,23 +1,37 @@
 #pragma once
 
-#include "mysql-provider.h"
+#include <istream>
 
-namespace Utils
-{
-    class User;
-    class Pair;
-}
+#include "change-log.h"
+#include "storage.h"
 
 namespace ConfigServer
 {
-    class Provider final : public Utils::MySqlProvider
+    class CompiledSchema;
+
+    /**
+     * A slice of a full-table export, as newline-delimited JSON.
+     */
+    struct ExportChunk
+    {
+        std::string lines;
+        uint64_t lastId = 0;  // continue the export after this primary key
+        bool hasMore = false;
+    };
+
+    class Provider final : public Utils::StorageProvider
     {
     public:
-        explicit Provider(const std::string& dbHost,
-                          const int dbPort,
-                          const std::string& username,
-                          const std::string& password,
-                          const std::string& database);
+        /**
+         * @brief importBatchSize is how many valid records each bulk import transaction inserts,
+         * changeLogCapacity how many of the latest insertions GET /config/changes can replay.
+         */
+        Provider(std::shared_ptr<Utils::Storage> storage, size_t importBatchSize, size_t changeLogCapacity);
+
+        /**
+         * @brief Every user and pair inserted through this provider, in order.
+         */
+        ChangeLog& changes() { return _changes; }
 
         /**
          * @brief Uses a prepared statement.
@@ -34,6 +48,19 @@ namespace ConfigServer
          */
         void insertPairSafe(const Utils::Pair& pair);
 
+        /**
+         * @brief Reads users from a JSON array or NDJSON body, validates each one against the
+         * schema and inserts the valid ones in batches, one transaction per batch. Returns a JSON
+         * object with a result per record: 201, 400 with the validation error, or 409 if the
+         * username is taken. Batches which were committed stay committed if a later one fails.
+         */
+        std::string importUsers(std::istream& body, const CompiledSchema& schema);
+
+        /**
+         * @brief Like importUsers(), for pairs.
+         */
+        std::string importPairs(std::istream& body, const CompiledSchema& schema);
+
         /**
          * @brief Lists all users in the database. Such methods should only be used for debugging purposes by
          * internal users like developers, or by other explicitly authorized users.
@@ -46,6 +73,27 @@ namespace ConfigServer
          */
         std::string getPairs();
 
+        /**
+         * @brief One keyset page of users, {"users":[...],"next_after_id":N}. The cursor is
+         * left out on the last page. Unlike getUsers(), the cost is bounded by limit.
+         */
+        std::string getUsersPage(uint64_t afterId, size_t limit);
+
+        /**
+         * @brief Like getUsersPage(), for pairs under a "pairs" key.
+         */
+        std::string getPairsPage(uint64_t afterId, size_t limit);
+
+        /**
+         * @brief The next chunk of a streamed export of every user, one per line.
+         */
+        ExportChunk exportUsers(uint64_t afterId, size_t limit);
+
+        /**
+         * @brief Like exportUsers(), for pairs.
+         */
+        ExportChunk exportPairs(uint64_t afterId, size_t limit);
+
         /**
          * @brief A not-so-unsafe method which can only return a single result, but still relies
          * on input sanitization.
@@ -57,5 +105,12 @@ namespace ConfigServer
          * If the input is not sanitized, it may lead to SQL injection vulnerabilities.
          */
         std::string getPairUnsafe(const std::string& origin, const std::string& destination);
+
+    private:
+        template<typename Record>
+        void recordChanges(Utils::Table table, const std::vector<Record>& records, const std::vector<bool>& inserted);
+
+        const size_t _importBatchSize;
+        ChangeLog _changes;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace ConfigServer
+{
+    /**
+     * Splits a bulk import body into individual JSON records. The body is either a JSON array
+     * or NDJSON, one record per line, told apart by its first character. Reading is done
+     * incrementally from the stream, so only the current record is ever copied out of it.
+     *
+     * Records are only delimited here, not parsed: a malformed record is still returned, so
+     * that it gets its own error while the rest of the import goes on.
+     */
+    class RecordReader
+    {
+    public:
+        explicit RecordReader(std::istream& input);
+
+        RecordReader(const RecordReader&) = delete;
+        RecordReader& operator=(const RecordReader&) = delete;
+
+        /**
+         * @brief Moves to the next record and returns false once there are none left. The
+         * view stays valid until the next call.
+         */
+        bool next(std::string_view& record);
+
+    private:
+        bool nextLine();
+        bool nextArrayElement();
+        void skipWhitespace();
+
+        std::streambuf& _input;
+        std::string _record;
+        bool _array = false;
+        bool _done = false;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <boost/json/value.hpp>
+
+namespace valijson
+{
+    class Schema;
+}
+
+namespace ConfigServer
+{
+    /**
+     * A JSON schema parsed and compiled once. Instances are immutable after construction,
+     * so a single instance may validate requests on any number of threads concurrently.
+     */
+    class CompiledSchema
+    {
+    public:
+        /**
+         * @brief Throws std::runtime_error if the schema is malformed or unsupported.
+         */
+        explicit CompiledSchema(const std::string& schemaJson);
+        ~CompiledSchema();
+
+        CompiledSchema(const CompiledSchema&) = delete;
+        CompiledSchema& operator=(const CompiledSchema&) = delete;
+
+        /**
+         * @brief Throws Utils::HttpBadRequest listing every violation if the target does not match.
+         */
+        void validate(const boost::json::value& target) const;
+
+    private:
+        std::unique_ptr<valijson::Schema> _schema;
+    };
+
+    enum class SchemaType
+    {
+        Pair = 0,
+        User,
+        Count
+    };
+
+    /**
+     * Loads and compiles the request schemas at startup and hands out shared, immutable
+     * instances. When hot reload is enabled, a background thread watches the schema files and
+     * atomically swaps in a recompiled schema; requests already in flight keep the old one.
+     */
+    class SchemaRegistry
+    {
+    public:
+        explicit SchemaRegistry(const std::string& pairSchemaPath, const std::string& userSchemaPath);
+        ~SchemaRegistry();
+
+        SchemaRegistry(const SchemaRegistry&) = delete;
+        SchemaRegistry& operator=(const SchemaRegistry&) = delete;
+
+        std::shared_ptr<const CompiledSchema> get(SchemaType type) const;
+
+        /**
+         * @brief Polls the schema files for modifications every interval. A schema that fails to
+         * compile is reported and the previous version stays active.
+         */
+        void startHotReload(std::chrono::milliseconds interval);
+
+    private:
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type lastWriteTime;
+            std::shared_ptr<const CompiledSchema> schema;
+        };
+
+        void load(Entry& entry);
+        void reloadChanged();
+
+        Entry _entries[static_cast<size_t>(SchemaType::Count)];
+
+        std::thread _reloadThread;
+        std::mutex _reloadMutex;
+        std::condition_variable _reloadCondition;
+        bool _stopReload = false;
+    };
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <openssl/ssl.h>
+
+#include "server_https.hpp"
+
+namespace ConfigServer
+{
+    /**
+     * The session ticket encryption keys. Tickets sealed with the previous key are still
+     * accepted after a rotation and renewed with the current one, so a rotation never forces
+     * a full handshake on clients that reconnect within one rotation period.
+     */
+    class TlsTicketKeys
+    {
+    public:
+        struct Key
+        {
+            unsigned char name[16];
+            unsigned char aesKey[32];
+            unsigned char hmacKey[32];
+        };
+
+        explicit TlsTicketKeys(std::chrono::seconds rotationInterval);
+
+        TlsTicketKeys(const TlsTicketKeys&) = delete;
+        TlsTicketKeys& operator=(const TlsTicketKeys&) = delete;
+
+        /**
+         * @brief The key to seal new tickets with, rotating it first if it has expired.
+         */
+        Key current();
+
+        /**
+         * @brief Looks up the key a ticket was sealed with. Returns false if it is unknown or
+         * expired, and sets isCurrent otherwise.
+         */
+        bool find(const unsigned char* name, Key& key, bool& isCurrent);
+
+    private:
+        static Key generate();
+
+        /**
+         * @brief Must hold _mutex.
+         */
+        void rotateIfDueLocked();
+
+        const std::chrono::seconds _rotationInterval;
+
+        std::mutex _mutex;
+        Key _current;
+        Key _previous;
+        bool _hasPrevious = false;
+        std::chrono::steady_clock::time_point _rotatedAt;
+    };
+
+    /**
+     * The [tls] options.
+     */
+    struct TlsSettings
+    {
+        unsigned int sessionCacheSize = 20480; // 0 disables the server-side session cache
+        unsigned int sessionTimeoutSeconds = 300;
+        bool sessionTickets = true;
+        unsigned int ticketKeyRotationSeconds = 3600;
+        std::string ciphers;      // TLS 1.2 and below, OpenSSL's default when empty
+        std::string ciphersuites; // TLS 1.3, OpenSSL's default when empty
+        std::string curves;       // key exchange groups, OpenSSL's default when empty
+
+        // Shared by every server built from these settings, so that a ticket issued by one
+        // acceptor resumes on any other. Each server makes its own if empty.
+        std::shared_ptr<TlsTicketKeys> ticketKeys;
+    };
+
+    /**
+     * Applies TlsSettings to an SSL_CTX, so that clients can resume sessions with an
+     * abbreviated handshake instead of paying for a full one on every connection.
+     *
+     * Full and resumed handshakes are counted in the tls_handshakes_total metrics.
+     */
+    class TlsSessionControl
+    {
+    public:
+        /**
+         * @brief Throws std::runtime_error if a cipher list or curve list is rejected by OpenSSL.
+         */
+        TlsSessionControl(SSL_CTX* context, const TlsSettings& settings);
+
+        TlsSessionControl(const TlsSessionControl&) = delete;
+        TlsSessionControl& operator=(const TlsSessionControl&) = delete;
+
+    private:
+        // The MAC context type the ticket key callback gets, which OpenSSL 3 changed.
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        using TicketMacContext = EVP_MAC_CTX;
+#else
+        using TicketMacContext = HMAC_CTX;
+#endif
+
+        /**
+         * @brief OpenSSL's session ticket key callback. Returns -1 on error, 0 if the ticket's
+         * key is unknown, 1 if the ticket was handled and 2 if it should be renewed.
+         */
+        static int ticketKeyCallback(SSL* ssl, unsigned char* keyName, unsigned char* iv,
+                                     EVP_CIPHER_CTX* cipherContext, TicketMacContext* macContext, int encrypt);
+
+        static void infoCallback(const SSL* ssl, int where, int ret);
+
+        std::shared_ptr<TlsTicketKeys> _ticketKeys;
+    };
+
+    /**
+     * The HTTPS server with its OpenSSL context configured from the [tls] options.
+     */
+    class TlsServer : public SimpleWeb::Server<SimpleWeb::HTTPS>
+    {
+    public:
+        TlsServer(const std::string& certificateFile, const std::string& privateKeyFile, const TlsSettings& settings)
+            : SimpleWeb::Server<SimpleWeb::HTTPS>(certificateFile, privateKeyFile),
+              _sessionControl(context.native_handle(), settings) {}
+
+    private:
+        TlsSessionControl _sessionControl;
+    };
+}
@@ -0,0 +1,117 @@
+#include "change-log.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "json-writer.h"
+#include "server-exceptions.h"
+
+namespace ConfigServer
+{
+    namespace
+    {
+        uint64_t initialVersion()
+        {
+            const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+        }
+    }
+
+    ChangeLog::ChangeLog(size_t capacity)
+        : _capacity(std::max<size_t>(capacity, 1)),
+          _version(initialVersion()),
+          _trimmedThrough(_version) {}
+
+    uint64_t ChangeLog::version() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _version;
+    }
+
+    void ChangeLog::append(Utils::Table table, std::string record)
+    {
+        std::map<uint64_t, Listener> listeners;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            if(_changes.size() == _capacity)
+            {
+                _trimmedThrough = _changes.front().version;
+                _changes.pop_front();
+            }
+
+            _changes.push_back(Change { ++_version, table, std::move(record) });
+            listeners.swap(_listeners);
+        }
+
+        for(auto& [id, listener] : listeners)
+        {
+            listener();
+        }
+    }
+
+    uint64_t ChangeLog::collect(uint64_t since, size_t limit, std::vector<Change>& out) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if(since < _trimmedThrough || since > _version)
+        {
+            throw Utils::HttpGone("Changes after version " + std::to_string(since) + " are no longer available, "
+                                  "resynchronize and continue from version " + std::to_string(_version) + ".");
+        }
+
+        // Versions are consecutive, so the first change newer than since is found by offset.
+        const size_t first = static_cast<size_t>(since - _trimmedThrough);
+        const size_t last = std::min(_changes.size(), first + limit);
+        for(size_t i = first; i < last; ++i)
+        {
+            out.push_back(_changes[i]);
+        }
+
+        return last > first ? _changes[last - 1].version : since;
+    }
+
+    uint64_t ChangeLog::subscribe(uint64_t since, Listener listener)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if(_version > since)
+        {
+            return 0;
+        }
+
+        const uint64_t id = _nextListenerId++;
+        _listeners.emplace(id, std::move(listener));
+        return id;
+    }
+
+    void ChangeLog::unsubscribe(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _listeners.erase(id);
+    }
+
+    std::string serializeChanges(uint64_t version, const std::vector<Change>& changes)
+    {
+        std::string out;
+        Utils::JsonWriter writer(out);
+
+        writer.beginObject();
+        writer.field("version", version);
+        writer.key("changes");
+        writer.beginArray();
+        for(const Change& change : changes)
+        {
+            writer.beginObject();
+            writer.field("version", change.version);
+            writer.field("table", Utils::getTableName(change.table));
+            writer.key("record");
+            writer.raw(change.record);
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+
+        return out;
+    }
+}
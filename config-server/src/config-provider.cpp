@@ -1,230 +1,265 @@
 #include "config-provider.h"
 
-#include <memory>
-
-#include <cppconn/resultset.h>
-#include <cppconn/statement.h>
-#include <cppconn/prepared_statement.h>
-#include <cppconn/exception.h>
-
-#include "pair.h"
-#include "user.h"
-#include "pointer-wrapper.h"
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "json-reader.h"
+#include "json-writer.h"
+#include "logger.h"
+#include "record-reader.h"
+#include "schema-registry.h"
 #include "server-exceptions.h"
+#include "tracing.h"
 
 namespace ConfigServer
 {
-    static const std::string usersRawStmt = "INSERT INTO users (name, password, type_id) VALUES (?,?,?)";
-    static const std::string pairsRawStmt = "INSERT INTO pairs (origin, destination, type, f_carrier) VALUES (?,?,?,?)";
-
-    Provider::Provider(const std::string& dbHost,
-                       const int dbPort,
-                       const std::string& username,
-                       const std::string& password,
-                       const std::string& database)
-        : Utils::MySqlProvider(dbHost, dbPort, username, password, database) {}
-
-    void Provider::insertUserSafe(const Utils::User& user)
+    namespace
     {
-        std::cout << "[DEBUG] Inserting user with username=" << user.username
-                  << ", password=" << user.password
-                  << ", type=" << static_cast<int>(user.type)
-                  << " using prepared statement " << usersRawStmt << std::endl;
-        try
-        {
-            auto stmt = prepareStatement(usersRawStmt);
-            stmt->setString(1, user.username);
-            stmt->setString(2, user.password);
-            stmt->setInt(3, static_cast<int>(user.type));
-            stmt->execute();
-        }
-        catch(const sql::SQLException& e)
+        // Keeps a batch's multi-row statements well under MySQL's 65535 placeholder limit.
+        constexpr size_t maxImportBatchSize = 10000;
+
+        /**
+         * @brief Shared by the user and pair imports. Results of invalid records are held back
+         * with the batch they were read in, so that results come out in record order.
+         */
+        template<typename Record, typename Parse, typename InsertBatch>
+        std::string importRecords(std::istream& body, const CompiledSchema& schema, size_t batchSize,
+                                  Parse parse, InsertBatch insertBatch)
         {
-            throw Utils::HttpInternalServerError(e.what());
-        }
-    }
-
-    void Provider::insertUserUnsafe(const Utils::User& user)
-    {
-        const std::string queryStr = "INSERT INTO users (name, password, type_id) VALUES ('" + user.username + "','" + user.password + "'," + std::to_string(static_cast<int>(user.type)) + ")";
-        std::cout << "[DEBUG] Executing query " << queryStr << std::endl;
+            struct Pending
+            {
+                size_t index;
+                std::string error; // empty for records waiting to be inserted
+            };
+
+            std::string out;
+            Utils::JsonWriter writer(out);
+            writer.beginObject();
+            writer.key("results");
+            writer.beginArray();
+
+            size_t created = 0;
+            size_t failed = 0;
+            std::vector<Pending> pending;
+            std::vector<Record> batch;
+            batch.reserve(batchSize);
+
+            const auto writeResult = [&](size_t index, int status, std::string_view error)
+            {
+                writer.beginObject();
+                writer.field("index", index);
+                writer.field("status", status);
+                if(!error.empty())
+                {
+                    writer.field("error", error);
+                }
+                writer.endObject();
+            };
 
-        try
-        {
-            auto stmt = createStatement();
-            stmt->execute(queryStr);
-        }
-        catch(const sql::SQLException& e)
-        {
-            throw Utils::HttpInternalServerError(e.what());
-        }
-    }
+            const auto flush = [&]()
+            {
+                const std::vector<bool> inserted = insertBatch(batch);
 
-    void Provider::insertPairSafe(const Utils::Pair& pair)
-    {
-        const std::string serializedPair = getPair(pair.origin, pair.destination);
-        if(!serializedPair.empty())
-        {
-            throw Utils::HttpStateConflict("Pair already exists.");
-        }
+                size_t batchIndex = 0;
+                for(const Pending& result : pending)
+                {
+                    if(!result.error.empty())
+                    {
+                        writeResult(result.index, 400, result.error);
+                        ++failed;
+                    }
+                    else if(inserted[batchIndex++])
+                    {
+                        writeResult(result.index, 201, "");
+                        ++created;
+                    }
+                    else
+                    {
+                        writeResult(result.index, 409, "Already exists.");
+                        ++failed;
+                    }
+                }
 
-        std::cout << "[DEBUG] Inserting pair with origin=" << pair.origin
-                  << ", destination=" << pair.destination
-                  << ", type=" << pair.type
-                  << ", fareCarrier=" << pair.fareCarrier
-                  << " using prepared statement " << pairsRawStmt << std::endl;
+                pending.clear();
+                batch.clear();
+            };
 
-        try
-        {
-            auto stmt = prepareStatement(pairsRawStmt);
-            stmt->setString(1, pair.origin);
-            stmt->setString(2, pair.destination);
-            stmt->setBoolean(3, pair.type);
-            stmt->setString(4, pair.fareCarrier);
-            stmt->execute();
-        }
-        catch(const sql::SQLException& e)
-        {
-            throw Utils::HttpInternalServerError(e.what());
-        }   
-    }
+            RecordReader reader(body);
+            std::string_view record;
+            for(size_t index = 0; reader.next(record); ++index)
+            {
+                try
+                {
+                    const Utils::JsonDocument document(record);
+                    schema.validate(document.root());
+                    batch.push_back(parse(document.root()));
+                    pending.push_back(Pending { index, "" });
+                }
+                catch(const Utils::HttpException& e)
+                {
+                    pending.push_back(Pending { index, e.what() });
+                }
 
-    std::string Provider::getUsers()
-    {
-        const std::string queryStr = "SELECT * FROM users";
-        std::cout << "[DEBUG] Executing query " << queryStr << std::endl;
+                if(pending.size() == batchSize)
+                {
+                    flush();
+                }
+            }
+            flush();
 
-        try
-        {
-            auto stmt = createStatement();
-            auto result = Utils::PointerWrapper(stmt->executeQuery(queryStr));
+            writer.endArray();
+            writer.field("created", created);
+            writer.field("failed", failed);
+            writer.endObject();
 
-            std::string resultStr = "[";
+            LOG_INFO("Bulk import finished, created=", created, ", failed=", failed);
+            return out;
+        }
 
-            while(result->next())
+        template<typename Record>
+        std::string serializePage(std::string_view key, const Utils::Page<Record>& page)
+        {
+            std::string out;
+            out.reserve(32 + page.records.size() * Record::serializedSizeHint);
+
+            Utils::JsonWriter writer(out);
+            writer.beginObject();
+            writer.key(key);
+            writer.beginArray();
+            for(const Record& record : page.records)
             {
-                if(resultStr.size() > 1)
-                {
-                    resultStr += ",";
-                }
+                record.serialize(writer);
+            }
+            writer.endArray();
+            if(page.hasMore)
+            {
+                writer.field("next_after_id", page.lastId);
+            }
+            writer.endObject();
 
-                Utils::User user {
-                    .username = result->getString("name"),
-                    .password = result->getString("password"),
-                    .type = static_cast<Utils::UserType>(result->getInt("type_id"))
-                };
+            return out;
+        }
 
-                const std::string serializedUser = user.serialize();
-                resultStr += serializedUser.substr(0, serializedUser.size() - 1); // remove newline 
+        template<typename Record>
+        ExportChunk toExportChunk(const Utils::Page<Record>& page)
+        {
+            ExportChunk chunk;
+            chunk.lines.reserve(page.records.size() * (Record::serializedSizeHint + 1));
+            for(const Record& record : page.records)
+            {
+                Utils::JsonWriter writer(chunk.lines);
+                record.serialize(writer);
+                chunk.lines += '\n';
             }
+            chunk.lastId = page.lastId;
+            chunk.hasMore = page.hasMore;
+            return chunk;
+        }
+    }
 
-            resultStr += "]";
+    Provider::Provider(std::shared_ptr<Utils::Storage> storage, size_t importBatchSize, size_t changeLogCapacity)
+        : Utils::StorageProvider(std::move(storage)),
+          _importBatchSize(std::clamp<size_t>(importBatchSize, 1, maxImportBatchSize)),
+          _changes(changeLogCapacity) {}
 
-            return resultStr;
-        }
-        catch(const sql::SQLException& e)
+    template<typename Record>
+    void Provider::recordChanges(Utils::Table table, const std::vector<Record>& records, const std::vector<bool>& inserted)
+    {
+        for(size_t i = 0; i < records.size(); ++i)
         {
-            throw Utils::HttpInternalServerError(e.what());
+            if(inserted[i])
+            {
+                _changes.append(table, records[i].serialize());
+            }
         }
     }
 
-    std::string Provider::getPairs()
+    void Provider::insertUserSafe(const Utils::User& user)
     {
-        const std::string queryStr = "SELECT * FROM pairs";
-        std::cout << "[DEBUG] Executing query " << queryStr << std::endl;
+        _storage->insertUser(user);
+        _changes.append(Utils::Table::Users, user.serialize());
+    }
 
-        try
-        {       
-            auto stmt = createStatement();
-            auto result = Utils::PointerWrapper(stmt->executeQuery(queryStr));
+    void Provider::insertUserUnsafe(const Utils::User& user)
+    {
+        _storage->insertUserUnsafe(user);
+        _changes.append(Utils::Table::Users, user.serialize());
+    }
 
-            std::string resultStr = "[";
+    void Provider::insertPairSafe(const Utils::Pair& pair)
+    {
+        _storage->insertPair(pair);
+        _changes.append(Utils::Table::Pairs, pair.serialize());
+    }
 
-            while(result->next())
-            {
-                if(resultStr.size() > 1)
-                {
-                    resultStr += ",";
-                }
+    std::string Provider::importUsers(std::istream& body, const CompiledSchema& schema)
+    {
+        TRACE_SPAN("importUsers");
+        return importRecords<Utils::User>(body, schema, _importBatchSize, Utils::parseUser, [this](const std::vector<Utils::User>& users)
+        {
+            std::vector<bool> inserted = _storage->insertUsers(users);
+            recordChanges(Utils::Table::Users, users, inserted);
+            return inserted;
+        });
+    }
 
-                Utils::Pair pair {
-                    .origin = result->getString("origin"),
-                    .destination = result->getString("destination"),
-                    .type = result->getBoolean("type"),
-                    .fareCarrier = result->getString("f_carrier")
-                };
+    std::string Provider::importPairs(std::istream& body, const CompiledSchema& schema)
+    {
+        TRACE_SPAN("importPairs");
+        return importRecords<Utils::Pair>(body, schema, _importBatchSize, Utils::parsePair, [this](const std::vector<Utils::Pair>& pairs)
+        {
+            std::vector<bool> inserted = _storage->insertPairs(pairs);
+            recordChanges(Utils::Table::Pairs, pairs, inserted);
+            return inserted;
+        });
+    }
 
-                const std::string serializedPair = pair.serialize();
-                resultStr += serializedPair.substr(0, serializedPair.size() - 1); // remove newline
-            }
+    std::string Provider::getUsers()
+    {
+        return Utils::serializeArray(_storage->getUsers());
+    }
 
-            resultStr += "]";
+    std::string Provider::getPairs()
+    {
+        return Utils::serializeArray(_storage->getPairs());
+    }
 
-            return resultStr;   
-        }
-        catch(const sql::SQLException& e)
-        {
-            throw Utils::HttpInternalServerError(e.what());
-        }
+    std::string Provider::getUsersPage(uint64_t afterId, size_t limit)
+    {
+        return serializePage("users", _storage->getUsersPage(afterId, limit));
     }
 
-    std::string Provider::getPair(const std::string& origin, const std::string& destination)
+    std::string Provider::getPairsPage(uint64_t afterId, size_t limit)
     {
-        std::string resultStr = "";
-        const std::string queryStr = "SELECT * FROM pairs WHERE origin='" + origin + "' AND destination='" + destination + "'";
-        std::cout << "[DEBUG] Executing query " << queryStr << std::endl;
+        return serializePage("pairs", _storage->getPairsPage(afterId, limit));
+    }
 
-        try
-        {      
-            auto stmt = createStatement();
-            auto result = Utils::PointerWrapper(stmt->executeQuery(queryStr));
+    ExportChunk Provider::exportUsers(uint64_t afterId, size_t limit)
+    {
+        TRACE_SPAN("exportUsers");
+        return toExportChunk(_storage->getUsersPage(afterId, limit));
+    }
 
-            if(result->next())
-            {
-                Utils::Pair pair {
-                    .origin = result->getString("origin"),
-                    .destination = result->getString("destination"),
-                    .type = result->getBoolean("type"),
-                    .fareCarrier = result->getString("f_carrier")
-                };
-
-                resultStr = pair.serialize();
-            }
+    ExportChunk Provider::exportPairs(uint64_t afterId, size_t limit)
+    {
+        TRACE_SPAN("exportPairs");
+        return toExportChunk(_storage->getPairsPage(afterId, limit));
+    }
 
-            return resultStr;
-        }
-        catch(const sql::SQLException& e)
-        {
-            throw Utils::HttpInternalServerError(e.what());
-        }
+    std::string Provider::getPair(const std::string& origin, const std::string& destination)
+    {
+        const auto pair = _storage->getPair(origin, destination);
+        return pair ? pair->serialize() : "";
     }
 
     std::string Provider::getPairUnsafe(const std::string& origin, const std::string& destination)
     {
         std::string resultStr = "";
-        const std::string queryStr = "SELECT * FROM pairs WHERE origin='" + origin + "' AND destination='" + destination + "'";
-        std::cout << "[DEBUG] Executing query " << queryStr << std::endl;
-
-        try
-        {      
-            auto stmt = createStatement();
-            auto result = Utils::PointerWrapper(stmt->executeQuery(queryStr));
-
-            while(result->next())
-            {
-                Utils::Pair pair {
-                    .origin = result->getString("origin"),
-                    .destination = result->getString("destination"),
-                    .type = result->getBoolean("type"),
-                    .fareCarrier = result->getString("f_carrier")
-                };
-
-                resultStr += pair.serialize();
-            }
-        }
-        catch(const sql::SQLException& e)
+        for(const auto& pair : _storage->getPairsUnsafe(origin, destination))
         {
-            throw Utils::HttpInternalServerError(e.what());
+            resultStr += pair.serialize();
+            resultStr += '\n';
         }
 
         if(resultStr.empty())
@@ -0,0 +1,138 @@
+#include "record-reader.h"
+
+namespace ConfigServer
+{
+    namespace
+    {
+        constexpr int endOfInput = std::char_traits<char>::eof();
+
+        bool isWhitespace(int c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        void trimTrailingWhitespace(std::string& str)
+        {
+            while(!str.empty() && isWhitespace(static_cast<unsigned char>(str.back())))
+            {
+                str.pop_back();
+            }
+        }
+    }
+
+    RecordReader::RecordReader(std::istream& input) : _input(*input.rdbuf())
+    {
+        skipWhitespace();
+        if(_input.sgetc() == '[')
+        {
+            _input.sbumpc();
+            _array = true;
+        }
+    }
+
+    bool RecordReader::next(std::string_view& record)
+    {
+        if(_done || !(_array ? nextArrayElement() : nextLine()))
+        {
+            _done = true;
+            return false;
+        }
+
+        record = _record;
+        return true;
+    }
+
+    bool RecordReader::nextLine()
+    {
+        int c = 0;
+        while(c != endOfInput)
+        {
+            _record.clear();
+            skipWhitespace(); // also skips blank lines
+
+            while((c = _input.sbumpc()) != endOfInput && c != '\n')
+            {
+                _record += static_cast<char>(c);
+            }
+
+            trimTrailingWhitespace(_record);
+            if(!_record.empty())
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool RecordReader::nextArrayElement()
+    {
+        _record.clear();
+        skipWhitespace();
+
+        int c = _input.sgetc();
+        if(c == endOfInput || c == ']')
+        {
+            return false;
+        }
+
+        int depth = 0;
+        bool inString = false;
+        bool escaped = false;
+
+        while((c = _input.sgetc()) != endOfInput)
+        {
+            if(inString)
+            {
+                if(escaped)
+                {
+                    escaped = false;
+                }
+                else if(c == '\\')
+                {
+                    escaped = true;
+                }
+                else if(c == '"')
+                {
+                    inString = false;
+                }
+            }
+            else if(depth == 0 && (c == ',' || c == ']'))
+            {
+                break;
+            }
+            else if(c == '"')
+            {
+                inString = true;
+            }
+            else if(c == '{' || c == '[')
+            {
+                ++depth;
+            }
+            else if(c == '}' || c == ']')
+            {
+                --depth;
+            }
+
+            _record += static_cast<char>(c);
+            _input.sbumpc();
+        }
+
+        // Leave a closing bracket in place so that the next call ends the array.
+        if(c == ',')
+        {
+            _input.sbumpc();
+        }
+
+        trimTrailingWhitespace(_record);
+        return true;
+    }
+
+    void RecordReader::skipWhitespace()
+    {
+        while(isWhitespace(_input.sgetc()))
+        {
+            _input.sbumpc();
+        }
+    }
+}
@@ -0,0 +1,175 @@
+#include "schema-registry.h"
+
+#include <fstream>
+#include <sstream>
+
+#include <valijson/adapters/boost_json_adapter.hpp>
+#include <valijson/schema.hpp>
+#include <valijson/schema_parser.hpp>
+#include <valijson/validator.hpp>
+#include <valijson/validation_results.hpp>
+
+#include "logger.h"
+#include "server-exceptions.h"
+#include "tracing.h"
+
+namespace ConfigServer
+{
+    static std::string loadFileToString(const std::filesystem::path& filePath)
+    {
+        std::ifstream fileStream(filePath);
+        if(!fileStream.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + filePath.string());
+        }
+
+        std::stringstream buffer;
+        buffer << fileStream.rdbuf();
+
+        return buffer.str();
+    }
+
+    CompiledSchema::CompiledSchema(const std::string& schemaJson)
+        : _schema(std::make_unique<valijson::Schema>())
+    {
+        boost::system::error_code ec;
+        const auto schemaDoc = boost::json::parse(schemaJson, ec);
+        if(ec)
+        {
+            throw std::runtime_error("Error parsing JSON schema: " + ec.message());
+        }
+
+        if(!schemaDoc.is_object())
+        {
+            throw std::runtime_error("JSON schema must be an object");
+        }
+
+        const auto& obj = schemaDoc.get_object();
+        if(obj.find("$schema") == obj.end())
+        {
+            throw std::runtime_error("Error finding key $schema");
+        }
+
+        if(obj.find("$ref") != obj.end())
+        {
+            throw std::runtime_error("Top-level $ref is not supported");
+        }
+
+        valijson::SchemaParser schemaParser;
+        valijson::adapters::BoostJsonAdapter schemaAdapter(schemaDoc);
+        schemaParser.populateSchema(schemaAdapter, *_schema);
+    }
+
+    CompiledSchema::~CompiledSchema() = default;
+
+    void CompiledSchema::validate(const boost::json::value& target) const
+    {
+        TRACE_SPAN("validateSchema");
+
+        // Validators carry a per-instance regex cache, so each call gets its own.
+        valijson::Validator validator;
+        valijson::ValidationResults results;
+        valijson::adapters::BoostJsonAdapter targetAdapter(target);
+        if(validator.validate(*_schema, targetAdapter, &results))
+        {
+            return;
+        }
+
+        std::stringstream errorStream;
+        errorStream << "Validation failed with the following errors:\n";
+
+        valijson::ValidationResults::Error error;
+        unsigned int errorNum = 0;
+        while(results.popError(error))
+        {
+            errorStream << "#" << errorNum << "\n";
+            errorStream << "  ";
+            for(const std::string& contextElement : error.context)
+            {
+                errorStream << contextElement << " ";
+            }
+            errorStream << "\n";
+            errorStream << "    - " << error.description << "\n";
+            ++errorNum;
+        }
+
+        throw Utils::HttpBadRequest(errorStream.str());
+    }
+
+    SchemaRegistry::SchemaRegistry(const std::string& pairSchemaPath, const std::string& userSchemaPath)
+    {
+        _entries[static_cast<size_t>(SchemaType::Pair)].path = pairSchemaPath;
+        _entries[static_cast<size_t>(SchemaType::User)].path = userSchemaPath;
+
+        for(auto& entry : _entries)
+        {
+            load(entry);
+        }
+    }
+
+    SchemaRegistry::~SchemaRegistry()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_reloadMutex);
+            _stopReload = true;
+        }
+        _reloadCondition.notify_all();
+
+        if(_reloadThread.joinable())
+        {
+            _reloadThread.join();
+        }
+    }
+
+    std::shared_ptr<const CompiledSchema> SchemaRegistry::get(SchemaType type) const
+    {
+        return std::atomic_load(&_entries[static_cast<size_t>(type)].schema);
+    }
+
+    void SchemaRegistry::startHotReload(std::chrono::milliseconds interval)
+    {
+        if(_reloadThread.joinable() || interval.count() <= 0)
+        {
+            return;
+        }
+
+        _reloadThread = std::thread([this, interval]()
+        {
+            std::unique_lock<std::mutex> lock(_reloadMutex);
+            while(!_reloadCondition.wait_for(lock, interval, [this]() { return _stopReload; }))
+            {
+                reloadChanged();
+            }
+        });
+    }
+
+    void SchemaRegistry::load(Entry& entry)
+    {
+        // Remember the timestamp first, so a broken edit is reported once rather than on every poll.
+        entry.lastWriteTime = std::filesystem::last_write_time(entry.path);
+        auto schema = std::make_shared<const CompiledSchema>(loadFileToString(entry.path));
+
+        std::atomic_store(&entry.schema, std::shared_ptr<const CompiledSchema>(std::move(schema)));
+    }
+
+    void SchemaRegistry::reloadChanged()
+    {
+        for(auto& entry : _entries)
+        {
+            try
+            {
+                if(std::filesystem::last_write_time(entry.path) == entry.lastWriteTime)
+                {
+                    continue;
+                }
+
+                load(entry);
+                LOG_INFO("Reloaded JSON schema ", entry.path.string());
+            }
+            catch(const std::exception& e)
+            {
+                LOG_ERROR("Keeping previous JSON schema ", entry.path.string(), ": ", e.what());
+            }
+        }
+    }
+}
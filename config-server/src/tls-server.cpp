@@ -0,0 +1,248 @@
+#include "tls-server.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else
+#include <openssl/hmac.h>
+#endif
+
+#include "logger.h"
+#include "metrics.h"
+
+namespace ConfigServer
+{
+    namespace
+    {
+        // Marks a connection whose handshake has been counted, since OpenSSL may report a
+        // TLS 1.3 handshake as done more than once.
+        int countedExDataIndex()
+        {
+            static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        int sessionControlExDataIndex()
+        {
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        Utils::Counter& fullHandshakes()
+        {
+            static Utils::Counter& counter = Utils::Metrics::instance().counter(
+                "tls_handshakes_full_total", "TLS handshakes which negotiated a new session.");
+            return counter;
+        }
+
+        Utils::Counter& resumedHandshakes()
+        {
+            static Utils::Counter& counter = Utils::Metrics::instance().counter(
+                "tls_handshakes_resumed_total", "TLS handshakes which resumed a cached session or ticket.");
+            return counter;
+        }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        bool initMac(EVP_MAC_CTX* macContext, const unsigned char* key, size_t keySize)
+        {
+            char digest[] = "SHA256";
+            OSSL_PARAM params[] = {
+                OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(key), keySize),
+                OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+                OSSL_PARAM_construct_end()
+            };
+            return EVP_MAC_CTX_set_params(macContext, params) == 1;
+        }
+#else
+        bool initMac(HMAC_CTX* macContext, const unsigned char* key, size_t keySize)
+        {
+            return HMAC_Init_ex(macContext, key, static_cast<int>(keySize), EVP_sha256(), nullptr) == 1;
+        }
+#endif
+    }
+
+    TlsTicketKeys::TlsTicketKeys(std::chrono::seconds rotationInterval)
+        : _rotationInterval(std::max(rotationInterval, std::chrono::seconds(1))),
+          _current(generate()),
+          _previous(),
+          _rotatedAt(std::chrono::steady_clock::now()) {}
+
+    TlsTicketKeys::Key TlsTicketKeys::generate()
+    {
+        Key key;
+        if(RAND_bytes(key.name, sizeof(key.name)) != 1 ||
+           RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1 ||
+           RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1)
+        {
+            throw std::runtime_error("Failed to generate a TLS session ticket key.");
+        }
+        return key;
+    }
+
+    void TlsTicketKeys::rotateIfDueLocked()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if(now - _rotatedAt < _rotationInterval)
+        {
+            return;
+        }
+
+        _previous = _current;
+        _hasPrevious = true;
+        _current = generate();
+        _rotatedAt = now;
+
+        LOG_INFO("Rotated the TLS session ticket key");
+    }
+
+    TlsTicketKeys::Key TlsTicketKeys::current()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        rotateIfDueLocked();
+        return _current;
+    }
+
+    bool TlsTicketKeys::find(const unsigned char* name, Key& key, bool& isCurrent)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        rotateIfDueLocked();
+
+        if(std::memcmp(name, _current.name, sizeof(Key::name)) == 0)
+        {
+            key = _current;
+            isCurrent = true;
+            return true;
+        }
+
+        if(_hasPrevious && std::memcmp(name, _previous.name, sizeof(Key::name)) == 0)
+        {
+            key = _previous;
+            isCurrent = false;
+            return true;
+        }
+
+        return false;
+    }
+
+    TlsSessionControl::TlsSessionControl(SSL_CTX* context, const TlsSettings& settings)
+        : _ticketKeys(settings.ticketKeys ? settings.ticketKeys
+                                          : std::make_shared<TlsTicketKeys>(std::chrono::seconds(settings.ticketKeyRotationSeconds)))
+    {
+        if(!settings.ciphers.empty() && SSL_CTX_set_cipher_list(context, settings.ciphers.c_str()) != 1)
+        {
+            throw std::runtime_error("Invalid [tls] ciphers: " + settings.ciphers);
+        }
+
+        if(!settings.ciphersuites.empty() && SSL_CTX_set_ciphersuites(context, settings.ciphersuites.c_str()) != 1)
+        {
+            throw std::runtime_error("Invalid [tls] ciphersuites: " + settings.ciphersuites);
+        }
+
+        if(!settings.curves.empty() && SSL_CTX_set1_curves_list(context, settings.curves.c_str()) != 1)
+        {
+            throw std::runtime_error("Invalid [tls] curves: " + settings.curves);
+        }
+
+        if(settings.sessionCacheSize > 0)
+        {
+            SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(context, settings.sessionCacheSize);
+        }
+        else
+        {
+            SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF);
+        }
+        SSL_CTX_set_timeout(context, static_cast<long>(settings.sessionTimeoutSeconds));
+
+        if(settings.sessionTickets)
+        {
+            SSL_CTX_clear_options(context, SSL_OP_NO_TICKET);
+            SSL_CTX_set_ex_data(context, sessionControlExDataIndex(), this);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            SSL_CTX_set_tlsext_ticket_key_evp_cb(context, &ticketKeyCallback);
+#else
+            SSL_CTX_set_tlsext_ticket_key_cb(context, &ticketKeyCallback);
+#endif
+        }
+        else
+        {
+            SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+        }
+
+        SSL_CTX_set_info_callback(context, &infoCallback);
+
+        // Register the counters now so that they show up in /metrics before the first handshake.
+        fullHandshakes();
+        resumedHandshakes();
+
+        LOG_INFO("TLS session_cache_size=", settings.sessionCacheSize,
+                 ", session_timeout_s=", settings.sessionTimeoutSeconds,
+                 ", session_tickets=", settings.sessionTickets,
+                 ", ticket_key_rotation_s=", settings.ticketKeyRotationSeconds);
+    }
+
+    int TlsSessionControl::ticketKeyCallback(SSL* ssl, unsigned char* keyName, unsigned char* iv,
+                                             EVP_CIPHER_CTX* cipherContext, TicketMacContext* macContext, int encrypt)
+    {
+        auto* self = static_cast<TlsSessionControl*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), sessionControlExDataIndex()));
+        if(self == nullptr)
+        {
+            return -1;
+        }
+
+        try
+        {
+            if(encrypt)
+            {
+                const TlsTicketKeys::Key key = self->_ticketKeys->current();
+                std::memcpy(keyName, key.name, sizeof(key.name));
+
+                if(RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1 ||
+                   EVP_EncryptInit_ex(cipherContext, EVP_aes_256_cbc(), nullptr, key.aesKey, iv) != 1 ||
+                   !initMac(macContext, key.hmacKey, sizeof(key.hmacKey)))
+                {
+                    return -1;
+                }
+
+                return 1;
+            }
+
+            TlsTicketKeys::Key key;
+            bool isCurrent = false;
+            if(!self->_ticketKeys->find(keyName, key, isCurrent))
+            {
+                return 0; // unknown or expired key, fall back to a full handshake
+            }
+
+            if(!initMac(macContext, key.hmacKey, sizeof(key.hmacKey)) ||
+               EVP_DecryptInit_ex(cipherContext, EVP_aes_256_cbc(), nullptr, key.aesKey, iv) != 1)
+            {
+                return -1;
+            }
+
+            return isCurrent ? 1 : 2;
+        }
+        catch(const std::exception& e)
+        {
+            LOG_ERROR("TLS session ticket callback failed: ", e.what());
+            return -1;
+        }
+    }
+
+    void TlsSessionControl::infoCallback(const SSL* ssl, int where, int)
+    {
+        if(!(where & SSL_CB_HANDSHAKE_DONE) || SSL_get_ex_data(ssl, countedExDataIndex()) != nullptr)
+        {
+            return;
+        }
+
+        SSL_set_ex_data(const_cast<SSL*>(ssl), countedExDataIndex(), reinterpret_cast<void*>(1));
+        SSL_session_reused(ssl) ? resumedHandshakes().increment() : fullHandshakes().increment();
+    }
+}
@@ -2,7 +2,11 @@
 
 # Usage: bash http-flood.sh <URL> <REQUEST_RATE> <METHOD> [BODY_PATH]
 # Example: bash http-flood.sh 192.168.1.100:8080/path/to/source 50 GET
-# Example: bash http-flood.sh 192.168.1.100:8080/path/to/source 50 POST request_body.json
+# Example: bash http-flood.sh https://192.168.1.100:8080/path/to/source 50 POST request_body.json
+#
+# Sends requests at a constant rate until interrupted, through the native load generator.
+# Set LOAD_GENERATOR to its path if it is not at build/load-generator/bin/load-generator,
+# and AUTH to username:password to send Basic auth credentials.
 
 # Input Parameters
 URL="$1"
@@ -10,6 +14,8 @@ REQUEST_RATE="$2"
 METHOD="$3"
 BODY_PATH="$4"
 
+LOAD_GENERATOR="${LOAD_GENERATOR:-$(dirname "$0")/build/load-generator/bin/load-generator}"
+
 # Validate Input
 if [[ -z "$URL" || -z "$REQUEST_RATE" || -z "$METHOD" ]]; then
     echo "Usage: $0 <URL> <REQUEST_RATE> <METHOD> [BODY_PATH]"
@@ -21,31 +27,43 @@ if [[ "$METHOD" != "GET" && "$METHOD" != "POST" ]]; then
     exit 1
 fi
 
-# Ensure curl is installed
-if ! command -v curl &> /dev/null; then
-    echo "Error: curl is not installed. Please install it and try again."
+if [[ ! -x "$LOAD_GENERATOR" ]]; then
+    echo "Error: load generator not found at $LOAD_GENERATOR. Build the loadgenerator target or set LOAD_GENERATOR."
     exit 1
 fi
 
-# Function to perform HTTP requests
-send_request() {
-    if [[ "$METHOD" == "GET" ]]; then
-        curl -s -o /dev/null -w "Status: %{http_code}\n" --cacert server.crt "$URL"
-    elif [[ "$METHOD" == "POST" ]]; then
-        if [[ -f "$BODY_PATH" ]]; then
-            curl -s -o /dev/null -w "Status: %{http_code}\n" -X POST --cacert server.crt -H "Content-Type: application/json" --data @"$BODY_PATH" "$URL"
-        else
-            echo "Error: POST body file not found at $BODY_PATH"
-            exit 1
-        fi
+# Split [scheme://]host[:port][/path]
+ARGS=()
+if [[ "$URL" == https://* ]]; then
+    ARGS+=(--https)
+fi
+URL="${URL#*://}"
+
+HOST_PORT="${URL%%/*}"
+PATH_PART="${URL#"$HOST_PORT"}"
+PATH_PART="/${PATH_PART#/}"
+HOST="${HOST_PORT%%:*}"
+PORT="${HOST_PORT##*:}"
+if [[ "$PORT" == "$HOST_PORT" ]]; then
+    PORT=80
+fi
+
+TARGET="$METHOD $PATH_PART"
+if [[ "$METHOD" == "POST" ]]; then
+    if [[ ! -f "$BODY_PATH" ]]; then
+        echo "Error: POST body file not found at $BODY_PATH"
+        exit 1
     fi
-}
+    TARGET="$TARGET @$BODY_PATH"
+fi
+
+if [[ -n "$AUTH" ]]; then
+    ARGS+=(--user "$AUTH")
+fi
 
 # Main loop for load generation
 echo "Starting load test: $METHOD requests to $URL at $REQUEST_RATE requests/second"
 while true; do
-    for ((i = 0; i < REQUEST_RATE; i++)); do
-        send_request &
-    done
-    sleep 1
+    "$LOAD_GENERATOR" --host "$HOST" --port "$PORT" "${ARGS[@]}" \
+        --mode open --rate "$REQUEST_RATE" --connections 16 --duration 10 --target "$TARGET" || exit 1
 done
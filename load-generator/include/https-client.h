@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <openssl/ssl.h>
+
+#include "client_https.hpp"
+
+namespace LoadGenerator
+{
+    /**
+     * An HTTPS client which remembers the last TLS session the server gave it and offers it
+     * on every new connection, the way a browser does. With --no-keepalive this turns most
+     * connections into abbreviated handshakes, which is what the server's session cache and
+     * tickets are meant to make cheap.
+     *
+     * Must be used from a single thread, like every client of a Worker.
+     */
+    class HttpsClient : public SimpleWeb::Client<SimpleWeb::HTTPS>
+    {
+    public:
+        HttpsClient(const std::string& hostPort, const std::string& caFile, bool resumeSessions);
+
+        uint64_t fullHandshakes() const { return _fullHandshakes; }
+        uint64_t resumedHandshakes() const { return _resumedHandshakes; }
+
+    protected:
+        std::shared_ptr<Connection> create_connection() noexcept override;
+
+    private:
+        static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+        static void infoCallback(const SSL* ssl, int where, int ret);
+
+        std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> _session { nullptr, &SSL_SESSION_free };
+        uint64_t _fullHandshakes = 0;
+        uint64_t _resumedHandshakes = 0;
+    };
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "client_https.hpp"
+#include "histogram.h"
+
+namespace LoadGenerator
+{
+    using HttpClient = SimpleWeb::Client<SimpleWeb::HTTP>;
+
+    enum class Mode
+    {
+        /** Every connection sends its next request as soon as the previous one completes. */
+        Closed = 0,
+        /** Requests are issued on a fixed schedule, independently of how fast the server responds. */
+        Open
+    };
+
+    struct Target
+    {
+        std::string method;
+        std::string path;
+        std::string body;
+
+        /**
+         * @brief The method and the path without its query string, used to group results.
+         */
+        std::string name() const;
+    };
+
+    /**
+     * @brief Parses "METHOD PATH [@BODY_FILE]". Throws std::invalid_argument if malformed.
+     */
+    Target parseTarget(const std::string& spec);
+
+    struct Settings
+    {
+        std::string host;
+        unsigned short port = 0;
+        std::string unixSocket; // connect here instead of host:port when set
+        bool https = false;
+        std::string caFile; // certificates are only verified when set
+        bool tlsResume = true; // offer the last TLS session on every new connection
+
+        Mode mode = Mode::Closed;
+        double rate = 0.0; // requests per second in total, open loop only
+        unsigned int connections = 1;
+        unsigned int threads = 1;
+        std::chrono::seconds duration { 10 };
+        std::chrono::seconds warmup { 0 };
+        bool keepAlive = true;
+        unsigned int timeoutSeconds = 10;
+
+        SimpleWeb::CaseInsensitiveMultimap headers;
+        std::vector<Target> targets;
+    };
+
+    /**
+     * TLS handshakes over the whole run, warmup included. Only filled in over HTTPS.
+     */
+    struct HandshakeStats
+    {
+        uint64_t full = 0;
+        uint64_t resumed = 0;
+
+        uint64_t total() const { return full + resumed; }
+    };
+
+    /**
+     * Results for one target. Latencies are in microseconds and, in open loop mode, measured
+     * from the time a request was scheduled to be sent rather than from when it actually was,
+     * which corrects for coordinated omission: a stalled server delays every queued request
+     * and that delay shows up in the percentiles instead of silently lowering the send rate.
+     */
+    struct EndpointStats
+    {
+        Utils::Histogram latencyMicros;
+        std::map<int, uint64_t> statusCodes;
+        uint64_t failures = 0; // connection errors and timeouts
+        uint64_t dropped = 0;  // scheduled but never sent before the run ended
+
+        uint64_t completed() const { return latencyMicros.count(); }
+        uint64_t successes() const;
+
+        void merge(const EndpointStats& other);
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "load-generator.h"
+
+namespace LoadGenerator
+{
+    /**
+     * @brief A human-readable table with one row per target and a total row, followed by the
+     * new connection rate and TLS resumption ratio over HTTPS.
+     */
+    void printReport(std::ostream& out, const Settings& settings, const std::vector<EndpointStats>& stats, const HandshakeStats& handshakes);
+
+    /**
+     * @brief The same results as JSON, for scripts. Latencies are in microseconds.
+     */
+    std::string renderJsonReport(const Settings& settings, const std::vector<EndpointStats>& stats, const HandshakeStats& handshakes);
+}
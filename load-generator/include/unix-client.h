@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "client_http.hpp"
+
+namespace LoadGenerator
+{
+    /**
+     * An HTTP client which connects to a server's Unix domain socket ([global] unix_socket)
+     * instead of host:port, to measure what co-located services save by skipping TCP.
+     *
+     * SimpleWeb only knows TCP sockets, so the connected Unix socket is handed to it as if
+     * it were one. Requests are sent with "Host: localhost".
+     */
+    class UnixSocketClient : public SimpleWeb::Client<SimpleWeb::HTTP>
+    {
+    public:
+        explicit UnixSocketClient(std::string socketPath);
+
+    protected:
+        void connect(const std::shared_ptr<Session>& session) override;
+
+    private:
+        const std::string _socketPath;
+    };
+}
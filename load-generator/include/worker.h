@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "https-client.h"
+#include "load-generator.h"
+#include "unix-client.h"
+
+namespace LoadGenerator
+{
+    /**
+     * Drives a share of the connections from a single thread with its own io_context, so
+     * workers never share state and their results are simply merged at the end.
+     *
+     * Each connection is a separate client used strictly serially, which keeps exactly one
+     * keep-alive socket open per connection.
+     */
+    template<typename ClientType>
+    class Worker
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        Worker(const Settings& settings, unsigned int connections, double rate, Clock::time_point start)
+            : _settings(settings),
+              _io(std::make_shared<SimpleWeb::asio::io_context>()),
+              _timer(*_io),
+              _rate(rate),
+              _start(start),
+              _measureFrom(start + settings.warmup),
+              _end(start + settings.warmup + settings.duration),
+              _stats(settings.targets.size())
+        {
+            for(unsigned int i = 0; i < connections; ++i)
+            {
+                _clients.push_back(makeClient());
+                _idle.push_back(i);
+            }
+            _inFlight.resize(connections);
+        }
+
+        Worker(const Worker&) = delete;
+        Worker& operator=(const Worker&) = delete;
+
+        /**
+         * @brief Blocks until the run is over and every outstanding request has completed or
+         * the drain period after the run has expired.
+         */
+        void run()
+        {
+            _timer.expires_at(_start);
+            _timer.async_wait([this](const SimpleWeb::error_code& ec)
+            {
+                if(!ec)
+                {
+                    _settings.mode == Mode::Open ? scheduleDue() : startClosedLoop();
+                }
+            });
+
+            _io->run();
+
+            for(const auto& pending : _pending)
+            {
+                ++_stats[pending.target].dropped;
+            }
+
+            // Still unanswered when the drain deadline stopped the run, so they timed out.
+            for(const auto& inFlight : _inFlight)
+            {
+                if(inFlight && inFlight->intended >= _measureFrom)
+                {
+                    ++_stats[inFlight->target].failures;
+                }
+            }
+        }
+
+        const std::vector<EndpointStats>& stats() const
+        {
+            return _stats;
+        }
+
+        HandshakeStats handshakes() const
+        {
+            HandshakeStats result;
+            if constexpr(std::is_same_v<ClientType, HttpsClient>)
+            {
+                for(const auto& client : _clients)
+                {
+                    result.full += client->fullHandshakes();
+                    result.resumed += client->resumedHandshakes();
+                }
+            }
+            return result;
+        }
+
+    private:
+        struct Pending
+        {
+            Clock::time_point intended;
+            size_t target;
+        };
+
+        std::unique_ptr<ClientType> makeClient()
+        {
+            const std::string hostPort = _settings.host + ":" + std::to_string(_settings.port);
+
+            std::unique_ptr<ClientType> client;
+            if constexpr(std::is_same_v<ClientType, HttpsClient>)
+            {
+                client = std::make_unique<ClientType>(hostPort, _settings.caFile, _settings.tlsResume);
+            }
+            else if constexpr(std::is_same_v<ClientType, UnixSocketClient>)
+            {
+                client = std::make_unique<ClientType>(_settings.unixSocket);
+            }
+            else
+            {
+                client = std::make_unique<ClientType>(hostPort);
+            }
+
+            client->io_service = _io;
+            client->config.timeout = _settings.timeoutSeconds;
+            client->config.timeout_connect = _settings.timeoutSeconds;
+            return client;
+        }
+
+        size_t nextTarget()
+        {
+            return _sequence++ % _settings.targets.size();
+        }
+
+        Clock::time_point intendedTime(uint64_t index) const
+        {
+            return _start + std::chrono::nanoseconds(static_cast<int64_t>(std::llround(static_cast<double>(index) * 1e9 / _rate)));
+        }
+
+        /**
+         * @brief Open loop: queue every request whose send time has come, hand them to idle
+         * connections and sleep until the next one is due.
+         */
+        void scheduleDue()
+        {
+            const auto now = Clock::now();
+            while(intendedTime(_scheduled) <= now && intendedTime(_scheduled) < _end)
+            {
+                _pending.push_back(Pending { intendedTime(_scheduled), nextTarget() });
+                ++_scheduled;
+            }
+
+            dispatch();
+
+            if(intendedTime(_scheduled) < _end)
+            {
+                _timer.expires_at(intendedTime(_scheduled));
+                _timer.async_wait([this](const SimpleWeb::error_code& ec)
+                {
+                    if(!ec)
+                    {
+                        scheduleDue();
+                    }
+                });
+            }
+            else
+            {
+                startDrainDeadline();
+                stopIfDone();
+            }
+        }
+
+        void startClosedLoop()
+        {
+            while(!_idle.empty())
+            {
+                const size_t connection = _idle.back();
+                _idle.pop_back();
+                send(connection, Pending { Clock::now(), nextTarget() });
+            }
+        }
+
+        void dispatch()
+        {
+            while(!_pending.empty() && !_idle.empty())
+            {
+                const size_t connection = _idle.back();
+                _idle.pop_back();
+
+                const Pending pending = _pending.front();
+                _pending.pop_front();
+                send(connection, pending);
+            }
+        }
+
+        void send(size_t connection, const Pending& pending)
+        {
+            const Target& target = _settings.targets[pending.target];
+
+            _inFlight[connection] = pending;
+            _clients[connection]->request(target.method, target.path, target.body, _settings.headers,
+                [this, connection, pending](std::shared_ptr<typename ClientType::Response> response, const SimpleWeb::error_code& ec)
+            {
+                onResponse(connection, pending, response ? std::atoi(response->status_code.c_str()) : 0, ec);
+            });
+        }
+
+        void onResponse(size_t connection, const Pending& pending, int statusCode, const SimpleWeb::error_code& ec)
+        {
+            const auto now = Clock::now();
+            _inFlight[connection].reset();
+
+            if(pending.intended >= _measureFrom)
+            {
+                EndpointStats& stats = _stats[pending.target];
+                if(ec)
+                {
+                    ++stats.failures;
+                }
+                else
+                {
+                    stats.latencyMicros.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - pending.intended).count()));
+                    ++stats.statusCodes[statusCode];
+                }
+            }
+
+            if(_settings.mode == Mode::Closed)
+            {
+                if(now < _end)
+                {
+                    send(connection, Pending { now, nextTarget() });
+                    return;
+                }
+
+                _idle.push_back(connection);
+                stopIfDone();
+                return;
+            }
+
+            _idle.push_back(connection);
+            dispatch();
+            stopIfDone();
+        }
+
+        /**
+         * @brief Bounds how long an overloaded server can keep the run going after its end.
+         */
+        void startDrainDeadline()
+        {
+            _timer.expires_at(_end + std::chrono::seconds(std::max(_settings.timeoutSeconds, 1u)));
+            _timer.async_wait([this](const SimpleWeb::error_code& ec)
+            {
+                if(!ec)
+                {
+                    _io->stop();
+                }
+            });
+        }
+
+        void stopIfDone()
+        {
+            const bool scheduleDone = _settings.mode == Mode::Closed || intendedTime(_scheduled) >= _end;
+            if(scheduleDone && _pending.empty() && _idle.size() == _clients.size())
+            {
+                _io->stop();
+            }
+        }
+
+        const Settings& _settings;
+        std::shared_ptr<SimpleWeb::asio::io_context> _io;
+        SimpleWeb::asio::steady_timer _timer;
+
+        const double _rate;
+        const Clock::time_point _start;
+        const Clock::time_point _measureFrom;
+        const Clock::time_point _end;
+
+        std::vector<std::unique_ptr<ClientType>> _clients;
+        std::vector<size_t> _idle;
+        std::vector<std::optional<Pending>> _inFlight; // per connection
+        std::deque<Pending> _pending;
+        uint64_t _scheduled = 0;
+        uint64_t _sequence = 0;
+
+        std::vector<EndpointStats> _stats;
+    };
+}
@@ -0,0 +1,85 @@
+#include "https-client.h"
+
+namespace LoadGenerator
+{
+    namespace
+    {
+        int clientExDataIndex()
+        {
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        // OpenSSL may report a TLS 1.3 handshake as done again after a post-handshake ticket.
+        int countedExDataIndex()
+        {
+            static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+            return index;
+        }
+
+        HttpsClient* clientOf(const SSL* ssl)
+        {
+            return static_cast<HttpsClient*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), clientExDataIndex()));
+        }
+    }
+
+    HttpsClient::HttpsClient(const std::string& hostPort, const std::string& caFile, bool resumeSessions)
+        : SimpleWeb::Client<SimpleWeb::HTTPS>(hostPort, !caFile.empty(), std::string(), std::string(), caFile)
+    {
+        SSL_CTX* ssl = context.native_handle();
+        SSL_CTX_set_ex_data(ssl, clientExDataIndex(), this);
+        SSL_CTX_set_info_callback(ssl, &infoCallback);
+
+        if(resumeSessions)
+        {
+            // Keep sessions out of OpenSSL's internal client cache, which is never consulted
+            // for outgoing connections anyway, and hand them to newSessionCallback instead.
+            SSL_CTX_set_session_cache_mode(ssl, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(ssl, &newSessionCallback);
+        }
+        else
+        {
+            SSL_CTX_set_session_cache_mode(ssl, SSL_SESS_CACHE_OFF);
+            SSL_CTX_set_options(ssl, SSL_OP_NO_TICKET);
+        }
+    }
+
+    std::shared_ptr<HttpsClient::Connection> HttpsClient::create_connection() noexcept
+    {
+        auto connection = SimpleWeb::Client<SimpleWeb::HTTPS>::create_connection();
+        if(_session)
+        {
+            SSL_set_session(connection->socket->native_handle(), _session.get());
+        }
+        return connection;
+    }
+
+    int HttpsClient::newSessionCallback(SSL* ssl, SSL_SESSION* session)
+    {
+        HttpsClient* client = clientOf(ssl);
+        if(client == nullptr)
+        {
+            return 0;
+        }
+
+        client->_session.reset(session);
+        return 1; // we own the reference now
+    }
+
+    void HttpsClient::infoCallback(const SSL* ssl, int where, int)
+    {
+        if(!(where & SSL_CB_HANDSHAKE_DONE) || SSL_get_ex_data(ssl, countedExDataIndex()) != nullptr)
+        {
+            return;
+        }
+
+        HttpsClient* client = clientOf(ssl);
+        if(client == nullptr)
+        {
+            return;
+        }
+
+        SSL_set_ex_data(const_cast<SSL*>(ssl), countedExDataIndex(), reinterpret_cast<void*>(1));
+        SSL_session_reused(ssl) ? ++client->_resumedHandshakes : ++client->_fullHandshakes;
+    }
+}
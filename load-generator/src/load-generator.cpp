@@ -0,0 +1,69 @@
+#include "load-generator.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace LoadGenerator
+{
+    std::string Target::name() const
+    {
+        return method + " " + path.substr(0, path.find('?'));
+    }
+
+    Target parseTarget(const std::string& spec)
+    {
+        std::istringstream stream(spec);
+        Target target;
+        std::string bodyRef;
+
+        if(!(stream >> target.method >> target.path) || target.path.front() != '/')
+        {
+            throw std::invalid_argument("Invalid target '" + spec + "', expected \"METHOD /path [@BODY_FILE]\".");
+        }
+
+        if(stream >> bodyRef)
+        {
+            if(bodyRef.front() != '@')
+            {
+                throw std::invalid_argument("Invalid target '" + spec + "', the body must be given as @BODY_FILE.");
+            }
+
+            std::ifstream file(bodyRef.substr(1));
+            if(!file.is_open())
+            {
+                throw std::invalid_argument("Could not open body file " + bodyRef.substr(1));
+            }
+
+            std::ostringstream body;
+            body << file.rdbuf();
+            target.body = body.str();
+        }
+
+        return target;
+    }
+
+    uint64_t EndpointStats::successes() const
+    {
+        uint64_t result = 0;
+        for(const auto& [code, count] : statusCodes)
+        {
+            if(code >= 200 && code < 300)
+            {
+                result += count;
+            }
+        }
+        return result;
+    }
+
+    void EndpointStats::merge(const EndpointStats& other)
+    {
+        latencyMicros.merge(other.latencyMicros);
+        for(const auto& [code, count] : other.statusCodes)
+        {
+            statusCodes[code] += count;
+        }
+        failures += other.failures;
+        dropped += other.dropped;
+    }
+}
@@ -0,0 +1,195 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include <boost/beast/core/detail/base64.hpp>
+
+#include "popl.hpp"
+#include "report.h"
+#include "worker.h"
+
+using namespace LoadGenerator;
+
+namespace
+{
+    std::string encodeBasicAuth(const std::string& credentials)
+    {
+        std::string encoded(boost::beast::detail::base64::encoded_size(credentials.size()), '\0');
+        encoded.resize(boost::beast::detail::base64::encode(encoded.data(), credentials.data(), credentials.size()));
+        return "Basic " + encoded;
+    }
+
+    template<typename ClientType>
+    std::vector<EndpointStats> runWorkers(const Settings& settings, HandshakeStats& handshakes)
+    {
+        // Leave the workers a moment to connect their clients before the first request is due.
+        const auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+
+        std::vector<std::unique_ptr<Worker<ClientType>>> workers;
+        for(unsigned int i = 0; i < settings.threads; ++i)
+        {
+            const unsigned int connections = settings.connections / settings.threads + (i < settings.connections % settings.threads ? 1 : 0);
+            const double rate = settings.rate * connections / settings.connections;
+            workers.push_back(std::make_unique<Worker<ClientType>>(settings, connections, rate, start));
+        }
+
+        std::vector<std::thread> threads;
+        for(auto& worker : workers)
+        {
+            threads.emplace_back([&worker]() { worker->run(); });
+        }
+
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::vector<EndpointStats> stats(settings.targets.size());
+        for(const auto& worker : workers)
+        {
+            for(size_t i = 0; i < stats.size(); ++i)
+            {
+                stats[i].merge(worker->stats()[i]);
+            }
+
+            handshakes.full += worker->handshakes().full;
+            handshakes.resumed += worker->handshakes().resumed;
+        }
+
+        return stats;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    popl::OptionParser op("Sends HTTP(S) load to one of the servers and reports latency percentiles per endpoint.\n"
+                          "Example: load-generator -p 8081 -u SuperAdmin1:password4 --mode open -r 500 -c 16 -d 30 \\\n"
+                          "             -t \"GET /flights?origin=SOF&destination=LON\"\n"
+                          "Options");
+
+    auto help = op.add<popl::Switch>("h", "help", "Print this message.");
+    auto host = op.add<popl::Value<std::string>>("", "host", "The server host.", "127.0.0.1");
+    auto port = op.add<popl::Value<unsigned short>>("p", "port", "The server port.");
+    auto https = op.add<popl::Switch>("", "https", "Connect over TLS, e.g. to config-server.");
+    auto unixSocket = op.add<popl::Value<std::string>>("", "unix-socket", "Connect to this Unix domain socket, a server's [global] unix_socket, instead of --host and --port.");
+    auto caFile = op.add<popl::Value<std::string>>("", "ca-file", "Verify the server certificate against this CA file. Without it, certificates are not verified.");
+    auto user = op.add<popl::Value<std::string>>("u", "user", "Basic auth credentials as username:password.");
+    auto targets = op.add<popl::Value<std::string>>("t", "target", "\"METHOD /path [@BODY_FILE]\", may be repeated. Targets are requested round-robin.");
+    auto headers = op.add<popl::Value<std::string>>("H", "header", "An extra \"Name: value\" request header, may be repeated.");
+    auto mode = op.add<popl::Value<std::string>>("", "mode", "closed: each connection sends back to back. open: requests are sent at --rate regardless of response times.", "closed");
+    auto rate = op.add<popl::Value<double>>("r", "rate", "Total requests per second in open mode.", 100.0);
+    auto connections = op.add<popl::Value<unsigned int>>("c", "connections", "Number of concurrent connections.", 1);
+    auto threads = op.add<popl::Value<unsigned int>>("", "threads", "Number of client threads, at most --connections.", 1);
+    auto duration = op.add<popl::Value<unsigned int>>("d", "duration", "Measured duration in seconds.", 10);
+    auto warmup = op.add<popl::Value<unsigned int>>("", "warmup", "Seconds of load before measuring starts.", 0);
+    auto noKeepAlive = op.add<popl::Switch>("", "no-keepalive", "Ask the server to close the connection after every response, so every request pays for a new connection.");
+    auto noTlsResume = op.add<popl::Switch>("", "no-tls-resume", "Do a full TLS handshake on every new connection instead of resuming the last session.");
+    auto timeout = op.add<popl::Value<unsigned int>>("", "timeout", "Connect and request timeout in seconds.", 10);
+    auto jsonPath = op.add<popl::Value<std::string>>("", "json", "Also write the results as JSON to this file.");
+
+    try
+    {
+        op.parse(argc, argv);
+
+        if(help->is_set() || !(port->is_set() || unixSocket->is_set()) || !targets->is_set())
+        {
+            std::cout << op << '\n';
+            return help->is_set() ? 0 : 1;
+        }
+
+        Settings settings;
+        settings.host = host->value();
+        settings.port = port->is_set() ? port->value() : 0;
+        settings.unixSocket = unixSocket->is_set() ? unixSocket->value() : "";
+        settings.https = https->is_set();
+        settings.caFile = caFile->is_set() ? caFile->value() : "";
+        settings.tlsResume = !noTlsResume->is_set();
+        settings.rate = rate->value();
+        settings.connections = std::max(connections->value(), 1u);
+        settings.threads = std::clamp(threads->value(), 1u, settings.connections);
+        settings.duration = std::chrono::seconds(std::max(duration->value(), 1u));
+        settings.warmup = std::chrono::seconds(warmup->value());
+        settings.keepAlive = !noKeepAlive->is_set();
+        settings.timeoutSeconds = timeout->value();
+
+        if(settings.https && !settings.unixSocket.empty())
+        {
+            throw std::invalid_argument("--https and --unix-socket cannot be combined.");
+        }
+
+        if(mode->value() == "open")
+        {
+            settings.mode = Mode::Open;
+            if(settings.rate <= 0.0)
+            {
+                throw std::invalid_argument("--rate must be positive in open mode.");
+            }
+        }
+        else if(mode->value() != "closed")
+        {
+            throw std::invalid_argument("--mode must be open or closed.");
+        }
+
+        // Every server rejects requests without these.
+        settings.headers.emplace("Content-Type", "application/json");
+        if(user->is_set())
+        {
+            settings.headers.emplace("Authorization", encodeBasicAuth(user->value()));
+        }
+        if(!settings.keepAlive)
+        {
+            settings.headers.emplace("Connection", "close");
+        }
+        for(size_t i = 0; i < headers->count(); ++i)
+        {
+            const std::string& header = headers->value(i);
+            const size_t colon = header.find(':');
+            if(colon == std::string::npos)
+            {
+                throw std::invalid_argument("Invalid header '" + header + "', expected \"Name: value\".");
+            }
+            const size_t valueStart = header.find_first_not_of(' ', colon + 1);
+            settings.headers.erase(header.substr(0, colon));
+            settings.headers.emplace(header.substr(0, colon), valueStart == std::string::npos ? std::string() : header.substr(valueStart));
+        }
+
+        for(size_t i = 0; i < targets->count(); ++i)
+        {
+            settings.targets.push_back(parseTarget(targets->value(i)));
+        }
+
+        const std::string server = settings.unixSocket.empty()
+            ? (settings.https ? "https://" : "http://") + settings.host + ":" + std::to_string(settings.port)
+            : "unix:" + settings.unixSocket;
+
+        std::cout << "Running " << (settings.mode == Mode::Open ? "open" : "closed") << " loop against " << server
+                  << " with " << settings.connections << " connections for " << settings.warmup.count() << "s warmup + "
+                  << settings.duration.count() << "s..." << std::endl;
+
+        HandshakeStats handshakes;
+        const auto stats = settings.https ? runWorkers<HttpsClient>(settings, handshakes)
+                         : !settings.unixSocket.empty() ? runWorkers<UnixSocketClient>(settings, handshakes)
+                         : runWorkers<HttpClient>(settings, handshakes);
+
+        printReport(std::cout, settings, stats, handshakes);
+
+        if(jsonPath->is_set())
+        {
+            std::ofstream file(jsonPath->value());
+            file << renderJsonReport(settings, stats, handshakes) << '\n';
+        }
+
+        return 0;
+    }
+    catch(const popl::invalid_option& e)
+    {
+        std::cerr << "Error parsing command line arguments: " << e.what() << '\n';
+        return 1;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "Fatal error: " << e.what() << '\n';
+        return 2;
+    }
+}
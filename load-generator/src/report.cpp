@@ -0,0 +1,157 @@
+#include "report.h"
+
+#include <cstdio>
+#include <iterator>
+
+#include "json-writer.h"
+
+namespace LoadGenerator
+{
+    namespace
+    {
+        constexpr double reportedPercentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+        constexpr const char* percentileKeys[] = { "p50", "p90", "p99", "p999" };
+
+        EndpointStats total(const std::vector<EndpointStats>& stats)
+        {
+            EndpointStats result;
+            for(const auto& endpoint : stats)
+            {
+                result.merge(endpoint);
+            }
+            return result;
+        }
+
+        std::string formatMillis(uint64_t micros)
+        {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.2fms", static_cast<double>(micros) / 1000.0);
+            return buf;
+        }
+
+        void printRow(std::ostream& out, const std::string& name, const EndpointStats& stats, double seconds)
+        {
+            char buf[256];
+            std::snprintf(buf, sizeof(buf), "%-40s %9llu %10.1f %9llu %8llu %8llu",
+                          name.c_str(),
+                          static_cast<unsigned long long>(stats.completed()),
+                          static_cast<double>(stats.completed()) / seconds,
+                          static_cast<unsigned long long>(stats.completed() - stats.successes()),
+                          static_cast<unsigned long long>(stats.failures),
+                          static_cast<unsigned long long>(stats.dropped));
+            out << buf;
+
+            for(const double percentile : reportedPercentiles)
+            {
+                std::snprintf(buf, sizeof(buf), " %10s", formatMillis(stats.latencyMicros.percentile(percentile)).c_str());
+                out << buf;
+            }
+
+            std::snprintf(buf, sizeof(buf), " %10s\n", formatMillis(stats.latencyMicros.max()).c_str());
+            out << buf;
+        }
+
+        void writeStats(Utils::JsonWriter& writer, const EndpointStats& stats, double seconds)
+        {
+            writer.field("requests", stats.completed());
+            writer.field("throughput_rps", static_cast<double>(stats.completed()) / seconds);
+            writer.field("successes", stats.successes());
+            writer.field("failures", stats.failures);
+            writer.field("dropped", stats.dropped);
+
+            writer.key("status_codes");
+            writer.beginObject();
+            for(const auto& [code, count] : stats.statusCodes)
+            {
+                writer.field(std::to_string(code), count);
+            }
+            writer.endObject();
+
+            writer.key("latency_us");
+            writer.beginObject();
+            for(size_t i = 0; i < std::size(reportedPercentiles); ++i)
+            {
+                writer.field(percentileKeys[i], stats.latencyMicros.percentile(reportedPercentiles[i]));
+            }
+            writer.field("max", stats.latencyMicros.max());
+            writer.field("mean", stats.latencyMicros.mean());
+            writer.endObject();
+        }
+    }
+
+    void printReport(std::ostream& out, const Settings& settings, const std::vector<EndpointStats>& stats, const HandshakeStats& handshakes)
+    {
+        const double seconds = static_cast<double>(settings.duration.count());
+
+        char header[256];
+        std::snprintf(header, sizeof(header), "%-40s %9s %10s %9s %8s %8s %10s %10s %10s %10s %10s\n",
+                      "Endpoint", "Requests", "Req/s", "Non-2xx", "Errors", "Dropped", "p50", "p90", "p99", "p99.9", "max");
+        out << header;
+
+        for(size_t i = 0; i < stats.size(); ++i)
+        {
+            printRow(out, settings.targets[i].name(), stats[i], seconds);
+        }
+
+        if(stats.size() > 1)
+        {
+            printRow(out, "Total", total(stats), seconds);
+        }
+
+        if(settings.https)
+        {
+            const double elapsed = static_cast<double>((settings.warmup + settings.duration).count());
+            std::snprintf(header, sizeof(header), "\nTLS handshakes: %llu full, %llu resumed (%.1f%%), %.1f new connections/s\n",
+                          static_cast<unsigned long long>(handshakes.full),
+                          static_cast<unsigned long long>(handshakes.resumed),
+                          handshakes.total() > 0 ? 100.0 * static_cast<double>(handshakes.resumed) / static_cast<double>(handshakes.total()) : 0.0,
+                          static_cast<double>(handshakes.total()) / elapsed);
+            out << header;
+        }
+    }
+
+    std::string renderJsonReport(const Settings& settings, const std::vector<EndpointStats>& stats, const HandshakeStats& handshakes)
+    {
+        const double seconds = static_cast<double>(settings.duration.count());
+
+        std::string out;
+        Utils::JsonWriter writer(out);
+
+        writer.beginObject();
+        writer.field("mode", settings.mode == Mode::Open ? "open" : "closed");
+        writer.field("rate", settings.rate);
+        writer.field("connections", settings.connections);
+        writer.field("threads", settings.threads);
+        writer.field("duration_s", seconds);
+
+        if(settings.https)
+        {
+            writer.key("tls_handshakes");
+            writer.beginObject();
+            writer.field("full", handshakes.full);
+            writer.field("resumed", handshakes.resumed);
+            writer.field("per_second", static_cast<double>(handshakes.total()) / static_cast<double>((settings.warmup + settings.duration).count()));
+            writer.endObject();
+        }
+
+        writer.key("endpoints");
+        writer.beginArray();
+        for(size_t i = 0; i < stats.size(); ++i)
+        {
+            writer.beginObject();
+            writer.field("name", settings.targets[i].name());
+            writeStats(writer, stats[i], seconds);
+            writer.endObject();
+        }
+        writer.endArray();
+
+        writer.key("total");
+        writer.beginObject();
+        writeStats(writer, total(stats), seconds);
+        writer.endObject();
+
+        writer.endObject();
+
+        return out;
+    }
+}
@@ -0,0 +1,84 @@
+#include "unix-client.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace LoadGenerator
+{
+    namespace
+    {
+        /**
+         * @brief A connected, non-blocking Unix socket, or -1 with ec set. Connecting to a
+         * Unix socket completes immediately or not at all, so there is nothing to wait for.
+         */
+        int connectUnix(const std::string& path, SimpleWeb::error_code& ec)
+        {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            if(path.size() >= sizeof(address.sun_path))
+            {
+                ec = SimpleWeb::error_code(ENAMETOOLONG, SimpleWeb::asio::error::get_system_category());
+                return -1;
+            }
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if(fd < 0)
+            {
+                ec = SimpleWeb::error_code(errno, SimpleWeb::asio::error::get_system_category());
+                return -1;
+            }
+
+            if(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+            {
+                ec = SimpleWeb::error_code(errno, SimpleWeb::asio::error::get_system_category()); // EAGAIN if the backlog is full
+                ::close(fd);
+                return -1;
+            }
+
+            return fd;
+        }
+    }
+
+    UnixSocketClient::UnixSocketClient(std::string socketPath)
+        : SimpleWeb::Client<SimpleWeb::HTTP>("localhost"),
+          _socketPath(std::move(socketPath)) {}
+
+    void UnixSocketClient::connect(const std::shared_ptr<Session>& session)
+    {
+        auto& socket = *session->connection->socket;
+        if(socket.is_open())
+        {
+            write(session);
+            return;
+        }
+
+        SimpleWeb::error_code ec;
+        const int fd = connectUnix(_socketPath, ec);
+        if(fd >= 0)
+        {
+            socket.assign(SimpleWeb::asio::ip::tcp::v6(), fd, ec);
+            if(ec)
+            {
+                ::close(fd);
+            }
+        }
+
+        if(ec)
+        {
+            // Report asynchronously, as a failed TCP connect would be, since the callback may
+            // send the next request right away.
+            SimpleWeb::asio::post(*io_service, [session, ec]()
+            {
+                session->callback(ec);
+            });
+            return;
+        }
+
+        write(session);
+    }
+}
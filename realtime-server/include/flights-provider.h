@@ -1,21 +1,19 @@
 #pragma once
 
-#include "mysql-provider.h"
+#include "flight-wire.h"
+#include "storage.h"
 
 namespace RealtimeServer
 {
-    class Provider final : public Utils::MySqlProvider
+    class Provider final : public Utils::StorageProvider
     {
     public:
-        explicit Provider(const std::string& dbHost,
-                          const int dbPort,
-                          const std::string& username,
-                          const std::string& password,
-                          const std::string& database);
+        explicit Provider(std::shared_ptr<Utils::Storage> storage);
 
-        void populateFlightsTable();
-        std::string getFlights(const std::string& origin, const std::string& destination);
-        
-    private:
+        /**
+         * @brief With a currency, every price is converted to it, see currency.h.
+         */
+        std::string getFlights(const std::string& origin, const std::string& destination,
+                               Utils::FlightFormat format = Utils::FlightFormat::Json, std::string_view currency = {});
     };
-}
\ No newline at end of file
+}
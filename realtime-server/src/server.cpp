@@ -5,6 +5,9 @@
 #include <set>
 
 #include "server-common.h"
+#include "reuse-port-server.h"
+#include "filtering-server.h"
+#include "unix-socket-server.h"
 #include "flights-provider.h"
 
 using HttpServer = SimpleWeb::Server<SimpleWeb::HTTP>;
@@ -15,13 +18,13 @@ static const char* executableName = "server";
 /**
  * Define server endpoints and behavior.
  */
-void addResources(HttpServer& server, std::shared_ptr<RealtimeServer::Provider> provider, const std::set<std::string>& blacklistedIPs)
+void addResources(HttpServer& server, std::shared_ptr<RealtimeServer::Provider> provider)
 {
-    server.default_resource["GET"] = [blacklistedIPs](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+    addDefaultResource(server, "GET", [](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
     {
         try
         {
-            validateNotBlacklisted(request, blacklistedIPs);
+            validateNotBlacklisted(request);
         }
         catch(const HttpException& e)
         {
@@ -37,20 +40,21 @@ void addResources(HttpServer& server, std::shared_ptr<RealtimeServer::Provider>
         {
             response->write(SimpleWeb::StatusCode::server_error_internal_server_error, std::string("Unexpected error: ") + e.what());
         }
-    };
+    });
 
-    server.resource["^/flights$"]["GET"] = [provider, blacklistedIPs](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
+    addResource(server, "^/flights$", "GET", [provider](std::shared_ptr<HttpServer::Response> response, std::shared_ptr<HttpServer::Request> request)
     {
         try
         {
-            validateNotBlacklisted(request, blacklistedIPs);
+            validateNotBlacklisted(request);
 
             verifyHeaders(request->header);
-			auto [username, password] = parseBasicAuthCredentials(request->header);
+			const BasicCredentials credentials = parseBasicAuthCredentials(request->header);
+			const std::string_view username = credentials.username();
 
-            if(!provider->isAuthenticated(username, password))
+            if(!provider->isAuthenticated(username, credentials.password()))
             {
-                std::cout << "[DEBUG] Authentication failed for user: " << username << " password: " << password << std::endl;
+                LOG_DEBUG("Authentication failed for user: ", username, " password: ", credentials.password());
                 throw HttpUnauthorized("Invalid username or password.");
             }
 
@@ -59,70 +63,77 @@ void addResources(HttpServer& server, std::shared_ptr<RealtimeServer::Provider>
                !provider->isAuthorized(username, UserType::Manager) &&
                !provider->isAuthorized(username, UserType::Admin))
             {
-                throw HttpForbidden("User " + username + " is not authorized to perform this action.");
+                throw HttpForbidden("User " + std::string(username) + " is not authorized to perform this action.");
             }
 
-            const auto queriesMap = request->parse_query_string();
+            // Airport codes fit std::string's inline storage, so none of this allocates.
+            char originBuffer[64];
+            char destinationBuffer[64];
+            const std::string origin(queryParameter(request->query_string, "origin", originBuffer));
+            const std::string destination(queryParameter(request->query_string, "destination", destinationBuffer));
 
-            std::string origin = "";
-            std::string destination = "";
+            char currencyBuffer[16];
+            const std::string_view currency = requestedCurrency(request->query_string, currencyBuffer);
 
-            const auto originIt = queriesMap.find("origin");
-            if(originIt != queriesMap.end())
             {
-                origin = originIt->second;
+                TRACE_SPAN("simulateFlightConstruction");
+                std::this_thread::sleep_for(std::chrono::seconds(1)); // Simulate complex flight construction.
             }
 
-            const auto destinationIt = queriesMap.find("destination");
-            if(destinationIt != queriesMap.end())
-            {
-                destination = destinationIt->second;
-            }
-
-            std::this_thread::sleep_for(std::chrono::seconds(1)); // Simulate complex flight construction.
-
-            response->write(provider->getFlights(origin, destination));
+            // Internal consumers can ask for the binary format, see flight-wire.h.
+            const FlightFormat format = requestedFlightFormat(*request);
+            writeCompressible(*response, *request, provider->getFlights(origin, destination, format, currency), flightResponseHeaders(format));
         }
         catch(const HttpException& e)
         {
             response->write(extractErrorCode(e), e.what());
         }
-    };
+    });
+
+    addIpFilterResource(server, provider);
+    addMetricsResource(server);
+    addTraceResource(server);
 }
 
-int main(int /*argc*/, char **argv)
+int main(int argc, char **argv)
 {
     try
     {
         const auto execPathWithFilename = std::string(argv[0]);
 		const auto execPath = execPathWithFilename.substr(0, execPathWithFilename.size() - strlen(executableName));
-		const auto configPath = execPath + "config.ini";
+		const auto configPath = argc > 1 ? std::string(argv[1]) : execPath + "config.ini";
 
         std::cout << "Parsing " << configPath << "..." << std::endl;
 
         Options options(configPath);
+        startAffinity(options);
+        startLogging(options);
+        startTracing(options);
+        startCompression(options);
+        startIpFilter(options);
+        startCurrency(options);
 
         std::cout << "Done." << std::endl;
 
-        HttpServer server;
-        
-        auto provider = std::make_shared<RealtimeServer::Provider>(options.getMySqlHost(),
-                                                                   options.getMySqlPort(),
-                                                                   options.getMySqlUsername(),
-                                                                   options.getMySqlPassword(),
-                                                                   options.getMySqlDatabase());
-        
-        configure(server, options);
-        addResources(server, provider, options.getBlacklistedIPs());
+        auto provider = std::make_shared<RealtimeServer::Provider>(createStorage(options));
+
+        auto servers = createServers(options, [&]()
+        {
+            auto server = std::make_unique<ReusePortServer<UnixSocketServer<FilteringHttpServer>>>();
+            configure(*server, options);
+            addResources(*server, provider);
+            return server;
+        });
 
-        std::thread serverThread([&server]()
+        std::thread serverThread([&servers]()
         {
-            server.start();
+            runServers(servers);
         });
 
-        std::cout << "Server started on port " << server.config.port << "..." << std::endl;
+        std::cout << "Server started on port " << options.getPort() << "..." << std::endl;
         
         serverThread.join();
+        Logger::instance().stop();
 
         return 0;
     }
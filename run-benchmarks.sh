@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# Usage: bash run-benchmarks.sh <BUILD_DIR> [save|compare] [THRESHOLD_PERCENT]
+# Example: bash run-benchmarks.sh build save       # record benchmarks/baseline.xml
+# Example: bash run-benchmarks.sh build compare 5  # fail if anything is >5% slower than the baseline
+
+BUILD_DIR="$1"
+MODE="${2:-compare}"
+THRESHOLD="${3:-5}"
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+BENCHMARKS="$BUILD_DIR/benchmarks/bin/benchmarks"
+BASELINE="$SCRIPT_DIR/benchmarks/baseline.xml"
+CURRENT="$BUILD_DIR/benchmarks/current.xml"
+
+# Validate Input
+if [[ -z "$BUILD_DIR" ]]; then
+    echo "Usage: $0 <BUILD_DIR> [save|compare] [THRESHOLD_PERCENT]"
+    exit 1
+fi
+
+if [[ "$MODE" != "save" && "$MODE" != "compare" ]]; then
+    echo "Error: mode must be save or compare."
+    exit 1
+fi
+
+if [[ ! -x "$BENCHMARKS" ]]; then
+    echo "Error: $BENCHMARKS not found. Build the benchmarks target first."
+    exit 1
+fi
+
+"$BENCHMARKS" --reporter XML::out="$CURRENT" --reporter console::out=-::colour-mode=none || exit 1
+
+if [[ "$MODE" == "save" ]]; then
+    cp "$CURRENT" "$BASELINE"
+    echo "Saved baseline to $BASELINE"
+    exit 0
+fi
+
+if [[ ! -f "$BASELINE" ]]; then
+    echo "Error: no baseline at $BASELINE. Run with 'save' first."
+    exit 1
+fi
+
+python3 "$SCRIPT_DIR/benchmarks/compare-benchmarks.py" "$BASELINE" "$CURRENT" "$THRESHOLD"
@@ -61,4 +61,63 @@ CREATE TABLE flights (
     FOREIGN KEY (pair_id) REFERENCES pairs(id)
 );
 
--- Table `flights` will be populated by the application.
\ No newline at end of file
+-- Table `flights` will be populated by the application.
+
+-- Bumped by the triggers below on every change, so that the servers can build ETags
+-- without querying the tables themselves. Each version grows by one per changed row.
+-- Multi-row writes set @skip_version_bump and add their row count once instead, so that
+-- they update this hot row once per transaction rather than once per row.
+CREATE TABLE table_versions (
+    name VARCHAR(16) NOT NULL,
+    version BIGINT UNSIGNED NOT NULL DEFAULT 0,
+    PRIMARY KEY (name)
+);
+
+INSERT INTO table_versions (name)
+VALUES
+("users"),
+("pairs"),
+("flights");
+
+DELIMITER $$
+
+CREATE TRIGGER users_insert_version AFTER INSERT ON users FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "users";
+END IF$$
+CREATE TRIGGER users_update_version AFTER UPDATE ON users FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "users";
+END IF$$
+CREATE TRIGGER users_delete_version AFTER DELETE ON users FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "users";
+END IF$$
+
+CREATE TRIGGER pairs_insert_version AFTER INSERT ON pairs FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "pairs";
+END IF$$
+CREATE TRIGGER pairs_update_version AFTER UPDATE ON pairs FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "pairs";
+END IF$$
+CREATE TRIGGER pairs_delete_version AFTER DELETE ON pairs FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "pairs";
+END IF$$
+
+CREATE TRIGGER flights_insert_version AFTER INSERT ON flights FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "flights";
+END IF$$
+CREATE TRIGGER flights_update_version AFTER UPDATE ON flights FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "flights";
+END IF$$
+CREATE TRIGGER flights_delete_version AFTER DELETE ON flights FOR EACH ROW
+IF @skip_version_bump IS NULL THEN
+    UPDATE table_versions SET version = version + 1 WHERE name = "flights";
+END IF$$
+
+DELIMITER ;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * @brief Parses a Linux CPU list such as "0-3,8,10-11", the format of taskset and of
+     * /sys/devices/system/node/nodeN/cpulist. Throws std::invalid_argument if malformed.
+     */
+    std::vector<unsigned int> parseCpuList(std::string_view list);
+
+    /**
+     * @brief The inverse of parseCpuList(), with consecutive CPUs joined into ranges.
+     */
+    std::string formatCpuList(const std::vector<unsigned int>& cpus);
+
+    struct NumaNode
+    {
+        unsigned int id;
+        std::vector<unsigned int> cpus;
+    };
+
+    /**
+     * @brief The NUMA nodes and their CPUs from sysfs, or one node with every CPU this process
+     * may run on if the kernel exposes no NUMA information.
+     */
+    std::vector<NumaNode> readNumaTopology();
+
+    /**
+     * Places server threads on CPUs chosen in the [affinity] section of config.ini.
+     *
+     * I/O threads, the ones running a server's io_context, are pinned to one CPU each, taken
+     * round-robin from io_cpus, so that every connection's state stays in one core's cache.
+     * Every other thread is confined to worker_cpus. With numa_local, pinned threads also ask
+     * the kernel to place their memory on their own NUMA node, so that per-thread data like
+     * the log and trace rings, which are allocated on first use, never lives across the
+     * interconnect.
+     *
+     * Empty CPU lists leave placement to the scheduler.
+     */
+    class Affinity
+    {
+    public:
+        static Affinity& instance();
+
+        Affinity(const Affinity&) = delete;
+        Affinity& operator=(const Affinity&) = delete;
+
+        /**
+         * @brief Throws std::invalid_argument if a list is malformed or names a CPU this
+         * process may not run on.
+         */
+        void configure(std::vector<unsigned int> ioCpus, std::vector<unsigned int> workerCpus, bool numaLocal);
+
+        /**
+         * @brief Pins the calling thread as the index-th I/O thread.
+         */
+        void pinIoThread(size_t index) const;
+
+        /**
+         * @brief Confines the calling thread to worker_cpus. Threads it starts afterwards
+         * inherit the placement.
+         */
+        void pinWorkerThread() const;
+
+        /**
+         * @brief The topology and the chosen placement, one line each, for the startup log.
+         */
+        std::string report() const;
+
+    private:
+        Affinity() = default;
+
+        void place(const std::vector<unsigned int>& cpus) const;
+
+        std::vector<unsigned int> _allowedCpus; // of the process, when configured
+        std::vector<unsigned int> _ioCpus;
+        std::vector<unsigned int> _workerCpus;
+        bool _numaLocal = false;
+    };
+}
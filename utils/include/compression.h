@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Utils
+{
+    enum class ContentEncoding
+    {
+        Identity,
+        Gzip,
+        Deflate
+    };
+
+    constexpr std::string_view getContentEncodingName(const ContentEncoding val)
+    {
+        switch(val)
+        {
+            case ContentEncoding::Gzip:     return "gzip";
+            case ContentEncoding::Deflate:  return "deflate";
+            default:                        return "identity";
+        }
+    }
+
+    /**
+     * @brief Picks the encoding to answer with from an Accept-Encoding header value. Honours
+     * q-values, including q=0 to refuse an encoding, and prefers gzip over deflate on a tie.
+     */
+    ContentEncoding negotiateEncoding(std::string_view acceptEncoding);
+
+    /**
+     * @brief Compresses body with zlib at the given level (1-9). Throws std::runtime_error
+     * if zlib fails.
+     */
+    std::string compress(std::string_view body, ContentEncoding encoding, int level);
+
+    /**
+     * Compresses response bodies according to the [compression] options. Servers keep
+     * returning the same few large bodies, e.g. the unfiltered flights or pairs lists, so the
+     * most recent compressed variants are cached and a hot response is compressed only once.
+     * Entries are keyed by the body itself, so a changed body never gets a stale variant.
+     */
+    class Compressor
+    {
+    public:
+        static Compressor& instance();
+
+        Compressor(const Compressor&) = delete;
+        Compressor& operator=(const Compressor&) = delete;
+
+        /**
+         * @brief A level of 0 disables compression. cacheEntries of 0 disables the cache.
+         */
+        void configure(int level, size_t minSize, size_t cacheEntries);
+
+        bool isEnabled() const { return _level > 0; }
+        size_t minSize() const { return _minSize; }
+
+        /**
+         * @brief Returns body encoded with encoding, from the cache if it has been compressed
+         * recently.
+         */
+        std::shared_ptr<const std::string> compress(std::string_view body, ContentEncoding encoding);
+
+    private:
+        struct Entry
+        {
+            size_t hash = 0;
+            ContentEncoding encoding = ContentEncoding::Identity;
+            std::string body;
+            std::shared_ptr<const std::string> compressed;
+        };
+
+        Compressor() = default;
+
+        int _level = 0;
+        size_t _minSize = 0;
+
+        std::mutex _cacheMutex;
+        std::vector<Entry> _cache;
+        size_t _nextEntry = 0; // replaced first once the cache is full
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "flight.h"
+
+namespace Utils
+{
+    /**
+     * @brief Multiplies every price by the factor at the same index, in place, and rounds the
+     * result to the nearest cent, ties to even. Runs four prices at a time with AVX where the
+     * CPU has it, and through scalePricesScalar() otherwise. Both give identical results.
+     */
+    void scalePrices(double* prices, const double* factors, size_t count);
+
+    void scalePricesScalar(double* prices, const double* factors, size_t count);
+
+    /**
+     * The exchange rates from currency.rates, for converting flight prices at query time.
+     * Configured once at startup and only read afterwards, so lookups take no lock.
+     */
+    class ExchangeRates
+    {
+    public:
+        static ExchangeRates& instance();
+
+        ExchangeRates(const ExchangeRates&) = delete;
+        ExchangeRates& operator=(const ExchangeRates&) = delete;
+
+        /**
+         * @brief Parses a comma-separated list of CODE:RATE, the units of each currency one
+         * unit of a common base buys, e.g. USD:1,EUR:0.92. Throws std::invalid_argument if
+         * malformed or a rate is not positive.
+         */
+        void configure(std::string_view rates);
+
+        bool knows(std::string_view currency) const;
+
+        /**
+         * @brief Converts every price to target, rounded to the cent, and sets the flights'
+         * currency to it.
+         * Throws std::invalid_argument if target or a flight's currency has no rate.
+         */
+        void convert(std::vector<Flight>& flights, std::string_view target) const;
+
+    private:
+        ExchangeRates() = default;
+
+        /**
+         * @brief The rate of currency, or 0 if unknown.
+         */
+        double rateOf(std::string_view currency) const;
+
+        // A handful of currencies, so a linear scan beats hashing.
+        std::vector<std::pair<std::string, double>> _rates;
+    };
+}
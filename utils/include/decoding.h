@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Utils
+{
+    namespace DecodingTables
+    {
+        constexpr int8_t invalid = -1;
+
+        constexpr std::array<int8_t, 256> makeHexTable()
+        {
+            std::array<int8_t, 256> table {};
+            for(auto& entry : table)
+            {
+                entry = invalid;
+            }
+            for(int i = 0; i < 10; ++i)
+            {
+                table['0' + i] = static_cast<int8_t>(i);
+            }
+            for(int i = 0; i < 6; ++i)
+            {
+                table['a' + i] = static_cast<int8_t>(10 + i);
+                table['A' + i] = static_cast<int8_t>(10 + i);
+            }
+            return table;
+        }
+
+        constexpr std::array<int8_t, 256> makeBase64Table()
+        {
+            constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+            std::array<int8_t, 256> table {};
+            for(auto& entry : table)
+            {
+                entry = invalid;
+            }
+            for(size_t i = 0; i < alphabet.size(); ++i)
+            {
+                table[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+            }
+            return table;
+        }
+
+        inline constexpr std::array<int8_t, 256> hex = makeHexTable();
+        inline constexpr std::array<int8_t, 256> base64 = makeBase64Table();
+    }
+
+    /**
+     * @brief Decodes %XX escapes from input into output, which must hold at least input.size()
+     * bytes. A '%' which is not followed by two hex digits is copied as is. With plusAsSpace,
+     * '+' decodes to a space, as in query strings. Returns the decoded length.
+     */
+    inline size_t percentDecode(std::string_view input, char* output, bool plusAsSpace = false)
+    {
+        using DecodingTables::hex;
+        using DecodingTables::invalid;
+
+        const size_t length = input.size();
+        size_t written = 0;
+
+        for(size_t i = 0; i < length; ++i)
+        {
+            const char c = input[i];
+            if(c == '%' && i + 2 < length)
+            {
+                const int8_t high = hex[static_cast<unsigned char>(input[i + 1])];
+                const int8_t low = hex[static_cast<unsigned char>(input[i + 2])];
+                if(high != invalid && low != invalid)
+                {
+                    output[written++] = static_cast<char>((high << 4) | low);
+                    i += 2;
+                    continue;
+                }
+            }
+
+            output[written++] = (plusAsSpace && c == '+') ? ' ' : c;
+        }
+
+        return written;
+    }
+
+    /**
+     * @brief Upper bound of the decoded size of base64 input of the given length.
+     */
+    constexpr size_t base64DecodedSize(size_t encodedLength)
+    {
+        return encodedLength / 4 * 3 + 3;
+    }
+
+    /**
+     * @brief Decodes standard, optionally padded base64 into output, which must hold at least
+     * base64DecodedSize(input.size()) bytes. Returns the decoded length, or -1 if the input
+     * contains anything outside the alphabet or has an impossible length.
+     */
+    inline ptrdiff_t base64Decode(std::string_view input, unsigned char* output)
+    {
+        using DecodingTables::base64;
+        using DecodingTables::invalid;
+
+        while(!input.empty() && input.back() == '=')
+        {
+            input.remove_suffix(1);
+        }
+
+        if(input.size() % 4 == 1)
+        {
+            return -1;
+        }
+
+        const auto* in = reinterpret_cast<const unsigned char*>(input.data());
+        const size_t fullQuads = input.size() / 4;
+        unsigned char* out = output;
+
+        for(size_t q = 0; q < fullQuads; ++q, in += 4)
+        {
+            const int8_t a = base64[in[0]], b = base64[in[1]], c = base64[in[2]], d = base64[in[3]];
+            if((a | b | c | d) < 0)
+            {
+                return -1;
+            }
+
+            const uint32_t bits = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | uint32_t(d);
+            *out++ = static_cast<unsigned char>(bits >> 16);
+            *out++ = static_cast<unsigned char>(bits >> 8);
+            *out++ = static_cast<unsigned char>(bits);
+        }
+
+        const size_t rest = input.size() % 4;
+        if(rest != 0)
+        {
+            uint32_t bits = 0;
+            for(size_t i = 0; i < rest; ++i)
+            {
+                const int8_t value = base64[in[i]];
+                if(value == invalid)
+                {
+                    return -1;
+                }
+                bits = (bits << 6) | uint32_t(value);
+            }
+
+            bits <<= 6 * (4 - rest);
+            *out++ = static_cast<unsigned char>(bits >> 16);
+            if(rest == 3)
+            {
+                *out++ = static_cast<unsigned char>(bits >> 8);
+            }
+        }
+
+        return out - output;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "flight.h"
+
+namespace Utils
+{
+    /**
+     * @brief Builds a Flight from the current row of a flights/pairs join. ResultSet is
+     * sql::ResultSet in the servers; anything with the same getters works, which is what
+     * lets the benchmarks measure this without a database.
+     */
+    template<typename ResultSet>
+    Flight readFlightRow(ResultSet& row)
+    {
+        return Flight {
+            .origin = row.getString("origin"),
+            .destination = row.getString("destination"),
+            .type = row.getBoolean("type") ? FlightType::Roundtrip : FlightType::OneWay,
+            .departureTime = row.getString("dep_datetime"),
+            .arrivalTime = row.getString("arr_datetime"),
+            .fareCarrier = row.getString("f_carrier"),
+            .price = row.getDouble("price"),
+            .currency = row.getString("currency"),
+            .cabin = static_cast<CabinType>(row.getInt("cabin"))
+        };
+    }
+
+    /**
+     * @brief Consumes the remaining rows.
+     */
+    template<typename ResultSet>
+    std::vector<Flight> readFlightRows(ResultSet& result)
+    {
+        std::vector<Flight> flights;
+        flights.reserve(result.rowsCount());
+
+        while(result.next())
+        {
+            flights.push_back(readFlightRow(result));
+        }
+
+        return flights;
+    }
+}
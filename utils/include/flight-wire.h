@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "flight.h"
+
+namespace Utils
+{
+    /**
+     * A compact binary encoding of a flight result set, for internal consumers which would
+     * otherwise serialize and parse JSON on both ends. Every integer is little-endian.
+     *
+     *   Header, 24 bytes:
+     *     char[4] magic           "FLTB"
+     *     u16     version         flightWireVersion
+     *     u16     recordSize      bytes per record, readers skip any they do not know
+     *     u32     totalSize       of the whole message, header included, for framing
+     *     u32     flightCount
+     *     u32     stringCount
+     *     u32     stringBytes
+     *   u32[stringCount + 1]      offsets of the interned strings, the last one is stringBytes
+     *   char[stringBytes]         the interned strings, back to back
+     *   flightCount records:
+     *     i64     departureTime   Unix seconds, UTC
+     *     i64     arrivalTime     Unix seconds, UTC
+     *     i64     price           in units of 1/flightPriceScale
+     *     u16     origin          string index
+     *     u16     destination     string index
+     *     u16     fareCarrier     string index
+     *     u16     currency        string index
+     *     u8      type            FlightType
+     *     u8      cabin           CabinType
+     *     u16     reserved        0
+     *
+     * Airport, carrier and currency codes repeat across a result set, so each is stored once.
+     * New fields are only ever appended to the record, so a version 1 reader can read any
+     * later version by honouring recordSize.
+     */
+    constexpr std::string_view flightWireMediaType = "application/x-flight-batch";
+    constexpr uint16_t flightWireVersion = 1;
+    constexpr int64_t flightPriceScale = 10000;
+
+    enum class FlightFormat
+    {
+        Json = 0,
+        Binary
+    };
+
+    /**
+     * @brief The format an Accept header asks for. Binary only if flightWireMediaType is
+     * listed with a q-value at least as high as JSON's.
+     */
+    FlightFormat negotiateFlightFormat(std::string_view accept);
+
+    /**
+     * @brief Parses "YYYY-MM-DD HH:MM:SS", as stored in the flights table, to Unix seconds.
+     * Throws std::invalid_argument if malformed.
+     */
+    int64_t parseDateTime(std::string_view dateTime);
+
+    /**
+     * @brief The inverse of parseDateTime().
+     */
+    std::string formatDateTime(int64_t seconds);
+
+    /**
+     * @brief Parses "YYYY-MM-DD" to days since 1970-01-01. Throws std::invalid_argument if malformed.
+     */
+    int64_t parseDate(std::string_view date);
+
+    /**
+     * @brief The inverse of parseDate().
+     */
+    std::string formatDate(int64_t day);
+
+    /**
+     * @brief Throws std::invalid_argument if a timestamp cannot be parsed or a result set has
+     * more than 65536 distinct codes.
+     */
+    std::string encodeFlights(const std::vector<Flight>& flights);
+
+    /**
+     * One decoded record. The strings point into the buffer the FlightBatchView was built on.
+     */
+    struct FlightRecordView
+    {
+        std::string_view origin;
+        std::string_view destination;
+        std::string_view fareCarrier;
+        std::string_view currency;
+        FlightType type;
+        CabinType cabin;
+        int64_t departureTime;
+        int64_t arrivalTime;
+        int64_t priceTicks;
+
+        double price() const
+        {
+            return static_cast<double>(priceTicks) / flightPriceScale;
+        }
+    };
+
+    /**
+     * Reads an encoded message in place. Construction validates the header and every offset
+     * up front, so that record access afterwards is bounds-check free, and nothing is ever
+     * copied or allocated.
+     */
+    class FlightBatchView
+    {
+    public:
+        /**
+         * @brief Throws std::invalid_argument if data is not a complete, well-formed message.
+         */
+        explicit FlightBatchView(std::string_view data);
+
+        size_t size() const
+        {
+            return _flightCount;
+        }
+
+        FlightRecordView operator[](size_t index) const
+        {
+            const char* record = _records + index * _recordSize;
+
+            FlightRecordView view;
+            view.departureTime = static_cast<int64_t>(read<uint64_t>(record));
+            view.arrivalTime = static_cast<int64_t>(read<uint64_t>(record + 8));
+            view.priceTicks = static_cast<int64_t>(read<uint64_t>(record + 16));
+            view.origin = string(read<uint16_t>(record + 24));
+            view.destination = string(read<uint16_t>(record + 26));
+            view.fareCarrier = string(read<uint16_t>(record + 28));
+            view.currency = string(read<uint16_t>(record + 30));
+            view.type = static_cast<FlightType>(static_cast<unsigned char>(record[32]));
+            view.cabin = static_cast<CabinType>(static_cast<unsigned char>(record[33]));
+            return view;
+        }
+
+    private:
+        template<typename T>
+        static T read(const char* at)
+        {
+            // Assembled byte by byte, so it is correct on any host and any alignment.
+            T value = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+            {
+                value |= static_cast<T>(static_cast<T>(static_cast<unsigned char>(at[i])) << (8 * i));
+            }
+            return value;
+        }
+
+        std::string_view string(uint16_t index) const
+        {
+            const uint32_t begin = read<uint32_t>(_offsets + 4 * index);
+            const uint32_t end = read<uint32_t>(_offsets + 4 * (index + 1));
+            return std::string_view(_strings + begin, end - begin);
+        }
+
+        const char* _offsets = nullptr;
+        const char* _strings = nullptr;
+        const char* _records = nullptr;
+        size_t _flightCount = 0;
+        size_t _recordSize = 0;
+    };
+}
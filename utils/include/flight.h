@@ -1,10 +1,12 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
+#include "json-writer.h"
+#include "logger.h"
 #include "server-exceptions.h"
 
 namespace Utils
@@ -36,21 +38,22 @@ namespace Utils
         Cabin
     };
 
-    static const std::unordered_map<FlightField, std::string> flightFields = {
-        { FlightField::Origin,         "origin" },
-        { FlightField::Destination,    "destination" },
-        { FlightField::Type,           "type" },
-        { FlightField::DepartureTime,  "departureTime" },
-        { FlightField::ArrivalTime,    "arrivalTime" },
-        { FlightField::FareCarrier,    "fareCarrier" },
-        { FlightField::Price,          "price" },
-        { FlightField::Currency,       "currency" },
-        { FlightField::Cabin,          "cabin" }
-    };
-
-    inline std::string getFlightFieldName(const FlightField val)
+    constexpr std::string_view getFlightFieldName(const FlightField val)
     {
-        return flightFields.find(val)->second;
+        switch(val)
+        {
+            case FlightField::Origin:           return "origin";
+            case FlightField::Destination:      return "destination";
+            case FlightField::Type:             return "type";
+            case FlightField::DepartureTime:    return "departureTime";
+            case FlightField::ArrivalTime:      return "arrivalTime";
+            case FlightField::FareCarrier:      return "fareCarrier";
+            case FlightField::Price:            return "price";
+            case FlightField::Currency:         return "currency";
+            case FlightField::Cabin:            return "cabin";
+        }
+
+        return "";
     }
 
     struct Flight
@@ -65,33 +68,35 @@ namespace Utils
         std::string currency;
         CabinType cabin;
 
-        std::string serialize() const
+        /**
+         * @brief A rough upper bound of the serialized size, used to reserve output buffers.
+         */
+        static constexpr size_t serializedSizeHint = 192;
+
+        void serialize(JsonWriter& writer) const
         {
-            try
-            {
-                boost::property_tree::ptree ptree;
-                std::ostringstream buf;
+            writer.beginObject();
+            writer.field(getFlightFieldName(FlightField::Origin), origin);
+            writer.field(getFlightFieldName(FlightField::Destination), destination);
+            writer.field(getFlightFieldName(FlightField::Type), static_cast<int>(type));
+            writer.field(getFlightFieldName(FlightField::DepartureTime), departureTime);
+            writer.field(getFlightFieldName(FlightField::ArrivalTime), arrivalTime);
+            writer.field(getFlightFieldName(FlightField::FareCarrier), fareCarrier);
+            writer.field(getFlightFieldName(FlightField::Price), price);
+            writer.field(getFlightFieldName(FlightField::Currency), currency);
+            writer.field(getFlightFieldName(FlightField::Cabin), static_cast<int>(cabin));
+            writer.endObject();
+        }
 
-                ptree.put(getFlightFieldName(FlightField::Origin), origin);
-                ptree.put(getFlightFieldName(FlightField::Destination), destination);
-                ptree.put(getFlightFieldName(FlightField::Type), static_cast<int>(type));
-                ptree.put(getFlightFieldName(FlightField::DepartureTime), departureTime);
-                ptree.put(getFlightFieldName(FlightField::ArrivalTime), arrivalTime);
-                ptree.put(getFlightFieldName(FlightField::FareCarrier), fareCarrier);
-                ptree.put(getFlightFieldName(FlightField::Price), price);
-                ptree.put(getFlightFieldName(FlightField::Currency), currency);
-                ptree.put(getFlightFieldName(FlightField::Cabin), static_cast<int>(cabin));
+        std::string serialize() const
+        {
+            std::string out;
+            out.reserve(serializedSizeHint);
 
-                boost::property_tree::write_json(buf, ptree, false);
+            JsonWriter writer(out);
+            serialize(writer);
 
-                return buf.str();
-            }
-            catch(const std::exception& e)
-            {
-                const std::string errorMessage = "An error occured while serializing a pair: " + std::string(e.what());
-                std::cerr << errorMessage << '\n';
-                throw HttpBadRequest(errorMessage);
-            }
+            return out;
         }
 
         static Flight parse(const std::string& serializedFlight)
@@ -104,15 +109,15 @@ namespace Utils
                 boost::property_tree::read_json(buf, ptree);
 
                 Flight flight {
-                    .origin = ptree.get<std::string>(getFlightFieldName(FlightField::Origin)),
-                    .destination = ptree.get<std::string>(getFlightFieldName(FlightField::Destination)),
-                    .type = static_cast<FlightType>(ptree.get<int>(getFlightFieldName(FlightField::Type))),
-                    .departureTime = ptree.get<std::string>(getFlightFieldName(FlightField::DepartureTime)),
-                    .arrivalTime = ptree.get<std::string>(getFlightFieldName(FlightField::ArrivalTime)),
-                    .fareCarrier = ptree.get<std::string>(getFlightFieldName(FlightField::FareCarrier)),
-                    .price = ptree.get<float>(getFlightFieldName(FlightField::Price)),
-                    .currency = ptree.get<std::string>(getFlightFieldName(FlightField::Currency)),
-                    .cabin = static_cast<CabinType>(ptree.get<int>(getFlightFieldName(FlightField::Cabin)))
+                    .origin = ptree.get<std::string>(getFlightFieldName(FlightField::Origin).data()),
+                    .destination = ptree.get<std::string>(getFlightFieldName(FlightField::Destination).data()),
+                    .type = static_cast<FlightType>(ptree.get<int>(getFlightFieldName(FlightField::Type).data())),
+                    .departureTime = ptree.get<std::string>(getFlightFieldName(FlightField::DepartureTime).data()),
+                    .arrivalTime = ptree.get<std::string>(getFlightFieldName(FlightField::ArrivalTime).data()),
+                    .fareCarrier = ptree.get<std::string>(getFlightFieldName(FlightField::FareCarrier).data()),
+                    .price = ptree.get<float>(getFlightFieldName(FlightField::Price).data()),
+                    .currency = ptree.get<std::string>(getFlightFieldName(FlightField::Currency).data()),
+                    .cabin = static_cast<CabinType>(ptree.get<int>(getFlightFieldName(FlightField::Cabin).data()))
                 };
 
                 return flight;
@@ -120,7 +125,7 @@ namespace Utils
             catch(const std::exception& e)
             {
                 const std::string errorMessage = "An error occured while deserializing a flight: " + std::string(e.what());
-                std::cerr << errorMessage << '\n';
+                LOG_WARNING(errorMessage);
                 throw HttpBadRequest(errorMessage);
             }
         }
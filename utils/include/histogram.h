@@ -0,0 +1,167 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils
+{
+    /**
+     * A log-linear (HDR style) histogram of non-negative integer values. Every power-of-two
+     * range is split into subBucketCount linear buckets, which bounds the relative error of any
+     * reported percentile to 1 / subBucketCount while keeping the bucket count small and fixed.
+     *
+     * This is the plain, single-threaded variant. Concurrent recording goes through
+     * ShardedHistogram in metrics.h, which snapshots into this type for reporting.
+     */
+    class Histogram
+    {
+    public:
+        static constexpr unsigned int subBucketBits = 4;
+        static constexpr uint64_t subBucketCount = uint64_t(1) << subBucketBits;
+        static constexpr unsigned int maxValueBits = 40;
+        static constexpr size_t bucketCount = (maxValueBits - subBucketBits + 1) * subBucketCount;
+        static constexpr uint64_t maxValue = (uint64_t(1) << maxValueBits) - 1;
+
+        static constexpr size_t bucketIndex(uint64_t value)
+        {
+            if(value > maxValue)
+            {
+                value = maxValue;
+            }
+
+            if(value < 2 * subBucketCount)
+            {
+                return static_cast<size_t>(value);
+            }
+
+            const unsigned int shift = 63 - __builtin_clzll(value) - subBucketBits;
+            return (shift + 1) * subBucketCount + ((value >> shift) - subBucketCount);
+        }
+
+        static constexpr uint64_t bucketLowerBound(size_t index)
+        {
+            if(index < 2 * subBucketCount)
+            {
+                return index;
+            }
+
+            const size_t shift = index / subBucketCount - 1;
+            return (subBucketCount + index % subBucketCount) << shift;
+        }
+
+        static constexpr uint64_t bucketUpperBound(size_t index)
+        {
+            if(index < 2 * subBucketCount)
+            {
+                return index;
+            }
+
+            const size_t shift = index / subBucketCount - 1;
+            return bucketLowerBound(index) + (uint64_t(1) << shift) - 1;
+        }
+
+        void record(uint64_t value, uint64_t count = 1)
+        {
+            _buckets[bucketIndex(value)] += count;
+            _count += count;
+            _sum += value * count;
+            if(value > _max)
+            {
+                _max = value;
+            }
+        }
+
+        /**
+         * @brief For rebuilding a histogram from raw bucket counts. The sum has to be added
+         * separately through addSum(), and the maximum is only known at bucket granularity.
+         */
+        void addBucket(size_t index, uint64_t count)
+        {
+            _buckets[index] += count;
+            _count += count;
+            if(count != 0 && bucketUpperBound(index) > _max)
+            {
+                _max = bucketUpperBound(index);
+            }
+        }
+
+        void addSum(uint64_t sum)
+        {
+            _sum += sum;
+        }
+
+        void merge(const Histogram& other)
+        {
+            for(size_t i = 0; i < bucketCount; ++i)
+            {
+                _buckets[i] += other._buckets[i];
+            }
+            _count += other._count;
+            _sum += other._sum;
+            if(other._max > _max)
+            {
+                _max = other._max;
+            }
+        }
+
+        /**
+         * @brief Returns the upper bound of the bucket containing the given percentile (0-100].
+         */
+        uint64_t percentile(double percent) const
+        {
+            if(_count == 0)
+            {
+                return 0;
+            }
+
+            uint64_t target = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(_count) + 0.5);
+            if(target == 0)
+            {
+                target = 1;
+            }
+
+            uint64_t seen = 0;
+            for(size_t i = 0; i < bucketCount; ++i)
+            {
+                seen += _buckets[i];
+                if(seen >= target)
+                {
+                    return bucketUpperBound(i) < _max ? bucketUpperBound(i) : _max;
+                }
+            }
+
+            return _max;
+        }
+
+        /**
+         * @brief Number of recorded values which are less than or equal to the given value,
+         * resolved at bucket granularity.
+         */
+        uint64_t countAtOrBelow(uint64_t value) const
+        {
+            uint64_t seen = 0;
+            for(size_t i = 0; i < bucketCount && bucketUpperBound(i) <= value; ++i)
+            {
+                seen += _buckets[i];
+            }
+            return seen;
+        }
+
+        uint64_t count() const { return _count; }
+        uint64_t sum() const { return _sum; }
+        uint64_t max() const { return _max; }
+        uint64_t bucket(size_t index) const { return _buckets[index]; }
+
+        double mean() const
+        {
+            return _count == 0 ? 0.0 : static_cast<double>(_sum) / static_cast<double>(_count);
+        }
+
+    private:
+        std::array<uint64_t, bucketCount> _buckets {};
+        uint64_t _count = 0;
+        uint64_t _sum = 0;
+        uint64_t _max = 0;
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "storage.h"
+
+namespace Utils
+{
+    /**
+     * A storage backend which keeps everything in process memory, for running and measuring
+     * the servers without a database. It starts with the same rows sql/create-tables.sql
+     * inserts and forgets every change on exit.
+     *
+     * Reads take a shared lock and writes an exclusive one, so concurrent readers never
+     * block each other.
+     */
+    class InMemoryStorage final : public Storage
+    {
+    public:
+        InMemoryStorage();
+
+        InMemoryStorage(const InMemoryStorage&) = delete;
+        InMemoryStorage& operator=(const InMemoryStorage&) = delete;
+
+        bool isAuthenticated(std::string_view username, std::string_view password) override;
+        bool isAuthorized(std::string_view username, UserType userType) override;
+
+        /**
+         * @brief Throws HttpStateConflict if the username is taken, like the UNIQUE constraint would.
+         */
+        void insertUser(const User& user) override;
+        void insertUserUnsafe(const User& user) override;
+        void insertPair(const Pair& pair) override;
+        std::vector<bool> insertUsers(const std::vector<User>& users) override;
+        std::vector<bool> insertPairs(const std::vector<Pair>& pairs) override;
+
+        std::vector<User> getUsers() override;
+        std::vector<Pair> getPairs() override;
+
+        /**
+         * @brief Rows are never deleted, so a record's key is its position plus one, like an
+         * AUTO_INCREMENT id.
+         */
+        Page<User> getUsersPage(uint64_t afterId, size_t limit) override;
+        Page<Pair> getPairsPage(uint64_t afterId, size_t limit) override;
+        std::optional<Pair> getPair(const std::string& origin, const std::string& destination) override;
+        std::vector<Pair> getPairsUnsafe(const std::string& origin, const std::string& destination) override;
+
+        std::vector<Flight> getFlights(const std::string& origin, const std::string& destination) override;
+
+        /**
+         * @brief A flight's key is its position in insertion order plus one.
+         */
+        Page<Flight> getFlightsPage(uint64_t afterId, size_t limit) override;
+        void insertMissingFlights(const std::function<Flight(const Pair&)>& makeFlight) override;
+
+        uint64_t getTableVersion(Table table) override;
+
+    private:
+        static std::string pairKey(const std::string& origin, const std::string& destination)
+        {
+            return origin + '-' + destination;
+        }
+
+        void insertUserLocked(const User& user);
+        void insertPairLocked(const Pair& pair);
+        void bumpVersion(Table table, uint64_t rows = 1);
+
+        template<typename Container>
+        static Page<typename Container::value_type> pageOf(const Container& rows, uint64_t afterId, size_t limit);
+
+        mutable std::shared_mutex _mutex;
+
+        // A deque never moves its elements, so the index can key on views of the usernames
+        // and authentication can look a user up without building a std::string.
+        std::deque<User> _users;
+        std::unordered_map<std::string_view, size_t> _userIndex;
+
+        std::vector<Pair> _pairs;
+        std::unordered_map<std::string, size_t> _pairIndex;
+
+        std::vector<std::vector<Flight>> _flightsByPair; // parallel to _pairs
+        std::vector<std::pair<size_t, size_t>> _flightOrder; // pair and position of every flight, in insertion order
+
+        // Read without the lock, so that version checks never wait for a writer. They start at
+        // the wall-clock microseconds of startup, since the contents of an earlier run are lost
+        // and its versions must not come back as ETags for different bodies.
+        std::array<std::atomic<uint64_t>, 3> _versions {};
+    };
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * An immutable set of IPv4 and IPv6 CIDR ranges, stored as a binary trie over the raw
+     * address bits, one trie per family. A lookup walks at most one node per prefix bit and
+     * stops at the first blocked prefix, so it never allocates or formats the address.
+     *
+     * IPv4-mapped IPv6 addresses (::ffff:a.b.c.d) are looked up as IPv4, and as IPv6 for
+     * the ranges shorter than /96 which cover them.
+     */
+    class CidrTrie
+    {
+    public:
+        CidrTrie() = default;
+
+        /**
+         * @brief Builds the trie from entries like "10.0.0.0/8", "2001:db8::/32" or a single
+         * address. Throws std::invalid_argument if an entry is malformed.
+         */
+        explicit CidrTrie(const std::vector<std::string>& entries);
+
+        /**
+         * @brief Address bytes in network order, 4 for IPv4 and 16 for IPv6.
+         */
+        bool contains(const unsigned char* address, size_t size) const;
+
+        /**
+         * @brief The entries in canonical form, e.g. "10.0.0.0/8" for "10.1.2.3/8".
+         */
+        const std::vector<std::string>& entries() const
+        {
+            return _entries;
+        }
+
+    private:
+        // Child slot values. Index 0 is the root, which is never anybody's child.
+        static constexpr uint32_t none = 0;
+        static constexpr uint32_t blocked = UINT32_MAX;
+
+        struct Node
+        {
+            uint32_t children[2] = { none, none };
+        };
+
+        struct Family
+        {
+            std::vector<Node> nodes = std::vector<Node>(1);
+            bool all = false; // a /0 entry
+        };
+
+        void insert(Family& family, const unsigned char* address, unsigned int prefixLength);
+        static bool contains(const Family& family, const unsigned char* address, unsigned int bits);
+
+        Family _v4;
+        Family _v6;
+        std::vector<std::string> _entries;
+    };
+
+    /**
+     * The IP blocklist of a server, set from security.blacklisted_ips and replaceable at
+     * runtime. Checks take no lock: each thread keeps its own reference to the current trie and
+     * only reloads it when the generation counter says it has been replaced, so a check on the
+     * hot path costs one atomic load and a walk of the trie.
+     */
+    class IpFilter
+    {
+    public:
+        static IpFilter& instance();
+
+        IpFilter(const IpFilter&) = delete;
+        IpFilter& operator=(const IpFilter&) = delete;
+
+        /**
+         * @brief Atomically swaps in a new blocklist. Connections already open are rejected by
+         * their next request.
+         */
+        void replace(std::shared_ptr<const CidrTrie> trie);
+
+        std::shared_ptr<const CidrTrie> current() const;
+
+        /**
+         * @brief Address bytes in network order, 4 for IPv4 and 16 for IPv6.
+         */
+        bool blocks(const unsigned char* address, size_t size) const;
+
+        /**
+         * @brief Works with any asio::ip::address.
+         */
+        template<typename Address>
+        bool blocks(const Address& address) const
+        {
+            if(address.is_v4())
+            {
+                const auto bytes = address.to_v4().to_bytes();
+                return blocks(bytes.data(), bytes.size());
+            }
+
+            const auto bytes = address.to_v6().to_bytes();
+            return blocks(bytes.data(), bytes.size());
+        }
+
+    private:
+        IpFilter();
+
+        std::shared_ptr<const CidrTrie> _trie;  // accessed through std::atomic_load/atomic_store only
+        std::atomic<uint64_t> _generation{ 1 }; // bumped after every replace()
+    };
+}
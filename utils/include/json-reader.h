@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <boost/json/monotonic_resource.hpp>
+#include <boost/json/parse.hpp>
+#include <boost/json/value.hpp>
+
+#include "server-exceptions.h"
+#include "tracing.h"
+
+namespace Utils
+{
+    /**
+     * A JSON DOM parsed exactly once per request body and shared by schema validation and
+     * struct extraction. Nodes are allocated from an arena which starts in an inline buffer,
+     * so typical request bodies are parsed without touching the heap. String views obtained
+     * through the accessors below point into that arena and live as long as the document.
+     */
+    class JsonDocument
+    {
+    public:
+        explicit JsonDocument(std::string_view json)
+            : _resource(_buffer, sizeof(_buffer)),
+              _root(parse(json, _resource)) {}
+
+        JsonDocument(const JsonDocument&) = delete;
+        JsonDocument& operator=(const JsonDocument&) = delete;
+
+        const boost::json::value& root() const
+        {
+            return _root;
+        }
+
+        const boost::json::object& object() const
+        {
+            if(!_root.is_object())
+            {
+                throw HttpBadRequest("Expected a JSON object.");
+            }
+
+            return _root.get_object();
+        }
+
+    private:
+        static constexpr size_t inlineBufferSize = 4096;
+
+        /**
+         * @brief Must be used to construct _root, since assigning a value would copy it out of the arena.
+         */
+        static boost::json::value parse(std::string_view json, boost::json::monotonic_resource& resource)
+        {
+            TRACE_SPAN("parseJson");
+
+            boost::system::error_code ec;
+            auto root = boost::json::parse(boost::json::string_view(json.data(), json.size()), ec, boost::json::storage_ptr(&resource));
+            if(ec)
+            {
+                throw HttpBadRequest("Error parsing JSON: " + ec.message());
+            }
+
+            return root;
+        }
+
+        unsigned char _buffer[inlineBufferSize];
+        boost::json::monotonic_resource _resource;
+        boost::json::value _root;
+    };
+
+    inline const boost::json::value& getJsonField(const boost::json::object& obj, std::string_view key)
+    {
+        const auto it = obj.find(boost::json::string_view(key.data(), key.size()));
+        if(it == obj.end())
+        {
+            throw HttpBadRequest("Missing field " + std::string(key) + ".");
+        }
+
+        return it->value();
+    }
+
+    inline std::string_view getJsonString(const boost::json::object& obj, std::string_view key)
+    {
+        const auto& val = getJsonField(obj, key);
+        if(!val.is_string())
+        {
+            throw HttpBadRequest("Field " + std::string(key) + " must be a string.");
+        }
+
+        const auto& str = val.get_string();
+        return std::string_view(str.data(), str.size());
+    }
+
+    inline std::int64_t getJsonInt(const boost::json::object& obj, std::string_view key)
+    {
+        const auto& val = getJsonField(obj, key);
+        if(val.is_int64())
+        {
+            return val.get_int64();
+        }
+
+        if(val.is_uint64())
+        {
+            return static_cast<std::int64_t>(val.get_uint64());
+        }
+
+        throw HttpBadRequest("Field " + std::string(key) + " must be an integer.");
+    }
+
+    /**
+     * @brief Accepts both JSON booleans and the 0/1 integers used by the request schemas.
+     */
+    inline bool getJsonBool(const boost::json::object& obj, std::string_view key)
+    {
+        const auto& val = getJsonField(obj, key);
+        if(val.is_bool())
+        {
+            return val.get_bool();
+        }
+
+        return getJsonInt(obj, key) != 0;
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace Utils
+{
+    /**
+     * A minimal streaming JSON emitter which appends directly into a caller-owned buffer.
+     * Keys are expected to be compile-time constants that never need escaping, values are escaped.
+     * Reserve the buffer up front when the output size is roughly known to avoid reallocations.
+     */
+    class JsonWriter
+    {
+    public:
+        explicit JsonWriter(std::string& out) : _out(out) {}
+
+        JsonWriter(const JsonWriter&) = delete;
+        JsonWriter& operator=(const JsonWriter&) = delete;
+
+        void beginObject()
+        {
+            separate();
+            _out += '{';
+            _needComma = false;
+        }
+
+        void endObject()
+        {
+            _out += '}';
+            _needComma = true;
+        }
+
+        void beginArray()
+        {
+            separate();
+            _out += '[';
+            _needComma = false;
+        }
+
+        void endArray()
+        {
+            _out += ']';
+            _needComma = true;
+        }
+
+        void key(std::string_view name)
+        {
+            separate();
+            _out += '"';
+            _out.append(name);
+            _out.append("\":", 2);
+            _needComma = false;
+        }
+
+        void value(std::string_view str)
+        {
+            separate();
+            _out += '"';
+            appendEscaped(str);
+            _out += '"';
+            _needComma = true;
+        }
+
+        void value(const char* str)
+        {
+            value(std::string_view(str));
+        }
+
+        void value(const std::string& str)
+        {
+            value(std::string_view(str));
+        }
+
+        void value(bool flag)
+        {
+            separate();
+            flag ? _out.append("true", 4) : _out.append("false", 5);
+            _needComma = true;
+        }
+
+        template<typename Integer, typename std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+        void value(Integer number)
+        {
+            separate();
+            char buf[24];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), number);
+            _out.append(buf, result.ptr - buf);
+            _needComma = true;
+        }
+
+        /**
+         * @brief Writes the shortest representation which round-trips to the same double.
+         * Non-finite values have no JSON representation and are written as null.
+         */
+        void value(double number)
+        {
+            separate();
+            if(!std::isfinite(number))
+            {
+                _out.append("null", 4);
+            }
+            else
+            {
+                char buf[32];
+                const auto result = std::to_chars(buf, buf + sizeof(buf), number);
+                _out.append(buf, result.ptr - buf);
+            }
+            _needComma = true;
+        }
+
+        void value(long double number)
+        {
+            value(static_cast<double>(number));
+        }
+
+        template<typename Value>
+        void field(std::string_view name, const Value& val)
+        {
+            key(name);
+            value(val);
+        }
+
+        /**
+         * @brief Appends pre-serialized JSON as the next value without any validation.
+         */
+        void raw(std::string_view json)
+        {
+            separate();
+            _out.append(json);
+            _needComma = true;
+        }
+
+    private:
+        void separate()
+        {
+            if(_needComma)
+            {
+                _out += ',';
+            }
+        }
+
+        void appendEscaped(std::string_view str)
+        {
+            static constexpr char hexDigits[] = "0123456789abcdef";
+
+            size_t chunkStart = 0;
+            for(size_t i = 0; i < str.size(); ++i)
+            {
+                const unsigned char c = static_cast<unsigned char>(str[i]);
+                if(c >= 0x20 && c != '"' && c != '\\')
+                {
+                    continue;
+                }
+
+                _out.append(str.data() + chunkStart, i - chunkStart);
+                chunkStart = i + 1;
+
+                switch(c)
+                {
+                    case '"':   _out.append("\\\"", 2); break;
+                    case '\\':  _out.append("\\\\", 2); break;
+                    case '\b':  _out.append("\\b", 2); break;
+                    case '\f':  _out.append("\\f", 2); break;
+                    case '\n':  _out.append("\\n", 2); break;
+                    case '\r':  _out.append("\\r", 2); break;
+                    case '\t':  _out.append("\\t", 2); break;
+                    default:
+                    {
+                        const char escaped[] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF] };
+                        _out.append(escaped, sizeof(escaped));
+                    }
+                }
+            }
+
+            _out.append(str.data() + chunkStart, str.size() - chunkStart);
+        }
+
+        std::string& _out;
+        bool _needComma = false;
+    };
+
+    /**
+     * Serializes a whole range of records into a single JSON array.
+     * Each record type must provide serialize(JsonWriter&) and a serializedSizeHint constant.
+     */
+    template<typename Range>
+    std::string serializeArray(const Range& records)
+    {
+        using Record = std::decay_t<decltype(*std::begin(records))>;
+
+        std::string out;
+        out.reserve(2 + static_cast<size_t>(std::distance(std::begin(records), std::end(records))) * Record::serializedSizeHint);
+
+        JsonWriter writer(out);
+        writer.beginArray();
+        for(const auto& record : records)
+        {
+            record.serialize(writer);
+        }
+        writer.endArray();
+
+        return out;
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Utils
+{
+    enum class LogLevel : int
+    {
+        Debug = 0,
+        Info,
+        Warning,
+        Error,
+        Off
+    };
+
+    /**
+     * @brief Accepts debug, info, warning, error and off. Throws std::invalid_argument otherwise.
+     */
+    LogLevel parseLogLevel(std::string_view level);
+
+    /**
+     * An asynchronous, leveled logger. Each thread formats messages into its own lock-free
+     * ring buffer and a single background thread drains all rings to stdout in batches, so
+     * logging never flushes or takes the global stream lock on the calling thread.
+     *
+     * Messages longer than a ring slot are truncated, and messages that find their ring full
+     * are dropped and counted rather than blocking the caller.
+     *
+     * Use the LOG_* macros below, which skip formatting entirely for disabled levels.
+     */
+    class Logger
+    {
+    public:
+        static Logger& instance();
+
+        Logger(const Logger&) = delete;
+        Logger& operator=(const Logger&) = delete;
+
+        /**
+         * @brief Only every debugSampleRate-th debug message per thread is kept, 1 keeps all.
+         */
+        void configure(LogLevel level, unsigned int debugSampleRate);
+
+        /**
+         * @brief Until started, messages are written synchronously.
+         */
+        void start();
+
+        /**
+         * @brief Drains all pending messages and stops the background writer.
+         */
+        void stop();
+
+        bool isEnabled(LogLevel level) const
+        {
+            return static_cast<int>(level) >= _level.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Applies debug sampling. Only meaningful after isEnabled(LogLevel::Debug).
+         */
+        bool shouldSampleDebug();
+
+        template<typename... Args>
+        void log(LogLevel level, const Args&... args)
+        {
+            thread_local std::string message;
+            message.clear();
+            (append(message, args), ...);
+            write(level, message);
+        }
+
+    private:
+        class Ring;
+
+        Logger() = default;
+        ~Logger();
+
+        void write(LogLevel level, std::string_view message);
+        Ring& localRing();
+        void run();
+        bool drain(std::string& out);
+
+        static void append(std::string& out, std::string_view str) { out.append(str); }
+        static void append(std::string& out, const char* str) { out.append(str); }
+        static void append(std::string& out, const std::string& str) { out.append(str); }
+        static void append(std::string& out, char c) { out += c; }
+        static void append(std::string& out, bool flag) { out.append(flag ? "true" : "false"); }
+
+        template<typename Number, typename std::enable_if_t<std::is_arithmetic_v<Number>, int> = 0>
+        static void append(std::string& out, Number number)
+        {
+            char buf[32];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), number);
+            out.append(buf, result.ptr - buf);
+        }
+
+        template<typename Enum, typename std::enable_if_t<std::is_enum_v<Enum>, int> = 0>
+        static void append(std::string& out, Enum value)
+        {
+            append(out, static_cast<std::underlying_type_t<Enum>>(value));
+        }
+
+        std::atomic<int> _level { static_cast<int>(LogLevel::Info) };
+        std::atomic<unsigned int> _debugSampleRate { 1 };
+
+        std::mutex _ringsMutex;
+        std::vector<std::shared_ptr<Ring>> _rings;
+
+        std::mutex _syncMutex;
+        std::atomic<bool> _running { false };
+        std::thread _writerThread;
+    };
+}
+
+#define UTILS_LOG(level, ...)                                                       \
+    do                                                                              \
+    {                                                                               \
+        auto& utilsLogger = Utils::Logger::instance();                             \
+        if(utilsLogger.isEnabled(level))                                            \
+        {                                                                           \
+            utilsLogger.log(level, __VA_ARGS__);                                    \
+        }                                                                           \
+    } while(0)
+
+#define LOG_DEBUG(...)                                                              \
+    do                                                                              \
+    {                                                                               \
+        auto& utilsLogger = Utils::Logger::instance();                             \
+        if(utilsLogger.isEnabled(Utils::LogLevel::Debug) && utilsLogger.shouldSampleDebug()) \
+        {                                                                           \
+            utilsLogger.log(Utils::LogLevel::Debug, __VA_ARGS__);                   \
+        }                                                                           \
+    } while(0)
+
+#define LOG_INFO(...) UTILS_LOG(Utils::LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) UTILS_LOG(Utils::LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) UTILS_LOG(Utils::LogLevel::Error, __VA_ARGS__)
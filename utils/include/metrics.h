@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "histogram.h"
+
+namespace Utils
+{
+    constexpr size_t metricsShardCount = 16;
+
+    /**
+     * @brief The shard owned by the calling thread. Threads are assigned shards round-robin on
+     * first use, so with up to metricsShardCount threads recording never shares a cache line.
+     */
+    size_t currentMetricsShard();
+
+    /**
+     * A monotonically increasing counter sharded per thread.
+     */
+    class Counter
+    {
+    public:
+        Counter(std::string name, std::string help) : _name(std::move(name)), _help(std::move(help)) {}
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        void increment(uint64_t by = 1)
+        {
+            _shards[currentMetricsShard()].value.fetch_add(by, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const;
+
+        const std::string& name() const { return _name; }
+        const std::string& help() const { return _help; }
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::atomic<uint64_t> value { 0 };
+        };
+
+        const std::string _name;
+        const std::string _help;
+        Shard _shards[metricsShardCount];
+    };
+
+    /**
+     * A Histogram which can be recorded into concurrently. Each thread records into its own
+     * shard with relaxed atomic increments and readers merge all shards into a snapshot.
+     */
+    class ShardedHistogram
+    {
+    public:
+        ShardedHistogram() : _shards(std::make_unique<Shard[]>(metricsShardCount)) {}
+
+        void record(uint64_t value)
+        {
+            Shard& shard = _shards[currentMetricsShard()];
+            shard.buckets[Histogram::bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        Histogram snapshot() const;
+
+    private:
+        struct alignas(64) Shard
+        {
+            std::atomic<uint64_t> buckets[Histogram::bucketCount] {};
+            std::atomic<uint64_t> sum { 0 };
+        };
+
+        std::unique_ptr<Shard[]> _shards;
+    };
+
+    /**
+     * Request count by status code, latency distribution, response bytes and in-flight requests
+     * for a single method and route.
+     */
+    class RouteMetrics
+    {
+    public:
+        static constexpr int trackedStatusCodes[] = { 200, 201, 204, 304, 400, 401, 403, 404, 409, 410, 413, 500 };
+        static constexpr size_t statusSlotCount = std::size(trackedStatusCodes) + 1; // the last slot counts any other code
+
+        RouteMetrics(std::string method, std::string route) : _method(std::move(method)), _route(std::move(route)) {}
+
+        RouteMetrics(const RouteMetrics&) = delete;
+        RouteMetrics& operator=(const RouteMetrics&) = delete;
+
+        void begin()
+        {
+            _shards[currentMetricsShard()].inFlight.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void end(int statusCode, std::chrono::nanoseconds latency, size_t bytes);
+
+        const std::string& method() const { return _method; }
+        const std::string& route() const { return _route; }
+
+        uint64_t requests(size_t statusSlot) const;
+        uint64_t bytes() const;
+        int64_t inFlight() const;
+        Histogram latencyMicros() const { return _latency.snapshot(); }
+
+    private:
+        static size_t statusSlot(int statusCode);
+
+        struct alignas(64) Shard
+        {
+            std::atomic<uint64_t> requests[statusSlotCount] {};
+            std::atomic<uint64_t> bytes { 0 };
+            std::atomic<int64_t> inFlight { 0 };
+        };
+
+        const std::string _method;
+        const std::string _route;
+        Shard _shards[metricsShardCount];
+        ShardedHistogram _latency;
+    };
+
+    /**
+     * The process-wide metrics registry. Metrics are registered at startup and live for the
+     * rest of the process, so references handed out by the registry never dangle.
+     */
+    class Metrics
+    {
+    public:
+        static Metrics& instance();
+
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+        /**
+         * @brief Returns the existing metrics if the method and route were registered before.
+         */
+        RouteMetrics& route(const std::string& method, const std::string& route);
+
+        Counter& counter(const std::string& name, const std::string& help);
+
+        /**
+         * @brief Renders every metric in the Prometheus text exposition format, version 0.0.4.
+         */
+        std::string renderPrometheus() const;
+
+    private:
+        Metrics() = default;
+
+        mutable std::mutex _mutex;
+        std::deque<RouteMetrics> _routes;
+        std::deque<Counter> _counters;
+    };
+}
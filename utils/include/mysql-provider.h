@@ -1,6 +1,9 @@
 #pragma once
 
-#include "user-type.h"
+#include <mutex>
+#include <string>
+
+#include "storage.h"
 
 namespace sql
 {
@@ -16,7 +19,11 @@ namespace Utils
     template<typename RawPtr>
     class PointerWrapper;
 
-    class MySqlProvider
+    /**
+     * The MySQL storage backend. All requests share a single connection, which is not
+     * thread-safe, so every method holds the connection for its whole duration.
+     */
+    class MySqlProvider final : public Storage
     {
     public:
         explicit MySqlProvider(const std::string& dbHost,
@@ -28,15 +35,78 @@ namespace Utils
         MySqlProvider(const MySqlProvider&) = delete;
         MySqlProvider& operator=(const MySqlProvider&) = delete;
 
-        bool isAuthenticated(const std::string& username,
-                             const std::string& password);
+        bool isAuthenticated(std::string_view username,
+                             std::string_view password) override;
+
+        bool isAuthorized(std::string_view username,
+                          UserType userType) override;
 
-        bool isAuthorized(const std::string& username,
-                          UserType userType);
+        /**
+         * @brief Uses a prepared statement.
+         */
+        void insertUser(const User& user) override;
 
-        virtual ~MySqlProvider();
+        /**
+         * @brief Uses string concatenation to build a query which can lead to SQL injection vulnerabilities.
+         */
+        void insertUserUnsafe(const User& user) override;
 
-    protected:
+        /**
+         * @brief Uses a prepared statement.
+         */
+        void insertPair(const Pair& pair) override;
+
+        /**
+         * @brief Locks the existing rows with SELECT ... FOR UPDATE and adds the new ones with a
+         * single multi-row prepared INSERT, all in one transaction. Names are compared case
+         * insensitively, like the column's collation does.
+         */
+        std::vector<bool> insertUsers(const std::vector<User>& users) override;
+
+        /**
+         * @brief Same approach as insertUsers().
+         */
+        std::vector<bool> insertPairs(const std::vector<Pair>& pairs) override;
+
+        std::vector<User> getUsers() override;
+        std::vector<Pair> getPairs() override;
+
+        /**
+         * @brief Uses a prepared statement over the primary key index.
+         */
+        Page<User> getUsersPage(uint64_t afterId, size_t limit) override;
+        Page<Pair> getPairsPage(uint64_t afterId, size_t limit) override;
+
+        /**
+         * @brief A not-so-unsafe method which can only return a single result, but still relies
+         * on input sanitization.
+         */
+        std::optional<Pair> getPair(const std::string& origin, const std::string& destination) override;
+
+        /**
+         * @brief Returns every row the concatenated query matches. If the input is not sanitized,
+         * it may lead to SQL injection vulnerabilities.
+         */
+        std::vector<Pair> getPairsUnsafe(const std::string& origin, const std::string& destination) override;
+
+        std::vector<Flight> getFlights(const std::string& origin, const std::string& destination) override;
+
+        /**
+         * @brief Like getPairsPage(), over the flights/pairs join.
+         */
+        Page<Flight> getFlightsPage(uint64_t afterId, size_t limit) override;
+
+        void insertMissingFlights(const std::function<Flight(const Pair&)>& makeFlight) override;
+
+        /**
+         * @brief Reads table_versions, which triggers keep current, so writes made by any
+         * server or by hand are noticed.
+         */
+        uint64_t getTableVersion(Table table) override;
+
+        ~MySqlProvider() override;
+
+    private:
         /**
          * @brief For SELECT queries. Afterwards call executeQuery() on the returned object.
          */
@@ -47,7 +117,17 @@ namespace Utils
          */
         PointerWrapper<sql::PreparedStatement> prepareStatement(const std::string& stmtStr);
 
-    private:
+        std::optional<Pair> getPairLocked(const std::string& origin, const std::string& destination);
+
+        /**
+         * @brief Inserts the given rows with one multi-row INSERT, bindRow setting the columns
+         * of each. If that hits a duplicate key, inserts them one at a time instead and clears
+         * inserted for the duplicates. Returns how many rows were inserted.
+         */
+        size_t insertRowsSkippingDuplicates(const std::vector<size_t>& rows, std::vector<bool>& inserted,
+                                            const std::string& insertPrefix, std::string_view rowPlaceholder,
+                                            const std::function<void(sql::PreparedStatement&, int&, size_t)>& bindRow);
+
         const std::string _dbHost;
         const int _dbPort;
         const std::string _username;
@@ -55,5 +135,6 @@ namespace Utils
         const std::string _database;
         sql::Driver* _driver;
         sql::Connection* _connection;
+        std::mutex _connectionMutex;
     };
-}
\ No newline at end of file
+}
@@ -1,11 +1,19 @@
 #pragma once
 
 #include <set>
+#include <vector>
 
 #include "popl.hpp"
+#include "affinity.h"
+#include "logger.h"
 
 namespace Utils
 {
+    /**
+     * @brief Splits a comma-separated list of IP addresses and CIDR ranges, as used by security.blacklisted_ips.
+     */
+    std::set<std::string> parseIPList(std::string ips);
+
     class Options
     {
     public:
@@ -17,6 +25,9 @@ namespace Utils
         int getPort() const;
         unsigned int getMaxRequestStreambufSize() const;
         unsigned int getThreadPoolSize() const;
+        unsigned int getAcceptors() const;
+        bool getListenTcp() const;
+        std::string getUnixSocket() const;
         unsigned int getTimeoutContent() const;
         unsigned int getTimeoutRequest() const;
 
@@ -24,6 +35,41 @@ namespace Utils
         std::string getPrivateKeyPath() const;
         std::set<std::string> getBlacklistedIPs() const;
 
+        unsigned int getSchemaReloadInterval() const;
+
+        std::vector<unsigned int> getIoCpus() const;
+        std::vector<unsigned int> getWorkerCpus() const;
+        bool getNumaLocal() const;
+
+        LogLevel getLogLevel() const;
+        unsigned int getDebugSampleRate() const;
+
+        unsigned int getTraceRingSize() const;
+        unsigned int getTraceSampleRate() const;
+        unsigned int getTraceSlowRequestMs() const;
+        std::string getTraceOutputDir() const;
+
+        unsigned int getCompressionLevel() const;
+        unsigned int getCompressionMinSize() const;
+        unsigned int getCompressionCacheEntries() const;
+
+        std::string getExchangeRates() const;
+
+        unsigned int getImportBatchSize() const;
+
+        unsigned int getChangeLogCapacity() const;
+        unsigned int getChangesMaxWait() const;
+
+        unsigned int getTlsSessionCacheSize() const;
+        unsigned int getTlsSessionTimeout() const;
+        bool getTlsSessionTickets() const;
+        unsigned int getTlsTicketKeyRotation() const;
+        std::string getTlsCiphers() const;
+        std::string getTlsCiphersuites() const;
+        std::string getTlsCurves() const;
+
+        std::string getStorageBackend() const;
+
         std::string getMySqlHost() const;
         int getMySqlPort() const;
         std::string getMySqlUsername() const;
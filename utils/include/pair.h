@@ -1,12 +1,12 @@
 #pragma once
 
-#include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
 
+#include "json-reader.h"
+#include "json-writer.h"
+#include "logger.h"
 #include "server-exceptions.h"
 
 namespace Utils
@@ -19,16 +19,17 @@ namespace Utils
         FareCarrier
     };
 
-    static const std::unordered_map<PairField, std::string> pairFields = {
-        { PairField::Origin,            "origin" },
-        { PairField::Destination,       "destination" },
-        { PairField::Type,              "type" },
-        { PairField::FareCarrier,       "fareCarrier" }
-    };
-
-    inline std::string getPairFieldName(const PairField val)
+    constexpr std::string_view getPairFieldName(const PairField val)
     {
-        return pairFields.find(val)->second;
+        switch(val)
+        {
+            case PairField::Origin:         return "origin";
+            case PairField::Destination:    return "destination";
+            case PairField::Type:           return "type";
+            case PairField::FareCarrier:    return "fareCarrier";
+        }
+
+        return "";
     }
 
     struct Pair
@@ -38,51 +39,56 @@ namespace Utils
         bool type; // 0 - one way, 1 - roundtrip
         std::string fareCarrier;
 
-        std::string serialize() const
+        static constexpr size_t serializedSizeHint = 80;
+
+        void serialize(JsonWriter& writer) const
         {
-            try
-            {
-                boost::property_tree::ptree ptree;
-                std::ostringstream buf;
+            writer.beginObject();
+            writer.field(getPairFieldName(PairField::Origin), origin);
+            writer.field(getPairFieldName(PairField::Destination), destination);
+            writer.field(getPairFieldName(PairField::Type), static_cast<int>(type));
+            writer.field(getPairFieldName(PairField::FareCarrier), fareCarrier);
+            writer.endObject();
+        }
 
-                ptree.put(getPairFieldName(PairField::Origin), origin);
-                ptree.put(getPairFieldName(PairField::Destination), destination);
-                ptree.put(getPairFieldName(PairField::Type), type);
-                ptree.put(getPairFieldName(PairField::FareCarrier), fareCarrier);
+        std::string serialize() const
+        {
+            std::string out;
+            out.reserve(serializedSizeHint);
 
-                boost::property_tree::write_json(buf, ptree, false);
+            JsonWriter writer(out);
+            serialize(writer);
 
-                return buf.str();
-            }
-            catch(const std::exception& e)
-            {
-                const std::string errorMessage = "An error occured while serializing a pair: " + std::string(e.what());
-                std::cerr << errorMessage << '\n';
-                throw HttpBadRequest(errorMessage);
-            }
+            return out;
         }
     };
 
-    static Pair parsePair(const std::string& serializedPair)
+    /**
+     * Extracts a pair from an already parsed (and usually already validated) request body.
+     */
+    static Pair parsePair(const boost::json::value& document)
     {
         try
         {
-            std::istringstream is(serializedPair);
-            boost::property_tree::ptree ptree;
-            boost::property_tree::read_json(is, ptree);
+            if(!document.is_object())
+            {
+                throw HttpBadRequest("Expected a JSON object.");
+            }
+
+            const auto& obj = document.get_object();
             Pair pair;
 
-            pair.origin = ptree.get<std::string>(getPairFieldName(PairField::Origin));
-            pair.destination = ptree.get<std::string>(getPairFieldName(PairField::Destination));
-            pair.type = ptree.get<bool>(getPairFieldName(PairField::Type));
-            pair.fareCarrier = ptree.get<std::string>(getPairFieldName(PairField::FareCarrier));
+            pair.origin = getJsonString(obj, getPairFieldName(PairField::Origin));
+            pair.destination = getJsonString(obj, getPairFieldName(PairField::Destination));
+            pair.type = getJsonBool(obj, getPairFieldName(PairField::Type));
+            pair.fareCarrier = getJsonString(obj, getPairFieldName(PairField::FareCarrier));
 
             return pair;
         }
         catch(const std::exception& e)
         {
             const std::string errorMessage = "An error occured while deserializing a pair: " + std::string(e.what());
-            std::cerr << errorMessage << '\n';
+            LOG_WARNING(errorMessage);
             throw HttpBadRequest(errorMessage);
         }
     }
@@ -25,6 +25,11 @@ namespace Utils
             return _ptr;
         }
 
+        RawPtr& operator*()
+        {
+            return *_ptr;
+        }
+
         ~PointerWrapper()
         {
             delete _ptr;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "flight.h"
+
+namespace Utils
+{
+    struct CalendarDay
+    {
+        int64_t day;                // days since 1970-01-01
+        int64_t priceTicks;         // of the cheapest departure that day, in units of 1/flightPriceScale
+        std::string_view currency;  // valid until the calendar is next changed
+        uint32_t flights;           // departures that day
+    };
+
+    /**
+     * The cheapest fare per departure day of every pair, for flexible-date search.
+     *
+     * Each pair keeps one dense array per currency, with a cell per day between its earliest
+     * and latest departure. A lookup over N days therefore reads N cells, no matter how many
+     * flights depart on each, and adding a flight updates a single cell. Cells never forget a
+     * flight, so a minimum never has to be recomputed from the flights behind it; flights that
+     * change or go away take a new calendar.
+     *
+     * Not thread-safe: callers must not add() while another thread looks up.
+     */
+    class PriceCalendar
+    {
+    public:
+        // Bounds the memory a single pair can take, about 10 years of days.
+        static constexpr int64_t maxSpanDays = 3660;
+
+        /**
+         * @brief Folds one flight in. Throws std::invalid_argument if its departure time cannot
+         * be parsed or lies more than maxSpanDays away from its pair's other departures.
+         */
+        void add(const Flight& flight);
+
+        /**
+         * @brief The days between fromDay and toDay, both included, with at least one
+         * departure from origin to destination, in date order. A pair priced in several
+         * currencies has one entry per currency on such days.
+         */
+        std::vector<CalendarDay> lookup(std::string_view origin, std::string_view destination, int64_t fromDay, int64_t toDay) const;
+
+        size_t flightCount() const
+        {
+            return _flightCount;
+        }
+
+    private:
+        struct Cell
+        {
+            int64_t priceTicks = std::numeric_limits<int64_t>::max();
+            uint32_t flights = 0;
+        };
+
+        struct Series
+        {
+            std::string currency;
+            int64_t firstDay = 0;
+            std::vector<Cell> cells; // cells[i] is firstDay + i
+        };
+
+        static std::string pairKey(std::string_view origin, std::string_view destination)
+        {
+            std::string key;
+            key.reserve(origin.size() + destination.size() + 1);
+            key.append(origin);
+            key += '-';
+            key.append(destination);
+            return key;
+        }
+
+        std::unordered_map<std::string, std::vector<Series>> _pairs;
+        size_t _flightCount = 0;
+    };
+}
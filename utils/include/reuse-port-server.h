@@ -0,0 +1,170 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "server_http.hpp"
+#include "affinity.h"
+#include "logger.h"
+#include "options.h"
+#include "unix-socket-server.h"
+
+namespace Utils
+{
+    /**
+     * A server which can share its port with other instances in the same process through
+     * SO_REUSEPORT. Each instance has its own acceptor and io_context, and the kernel spreads
+     * incoming connections between the listening sockets, so no two threads ever contend for
+     * the same acceptor or hand a connection over to another core.
+     *
+     * SimpleWeb's bind() sets its socket options after nothing but reuse_address can still
+     * be changed, so bindReusePort() takes its place.
+     */
+    template<typename ServerType>
+    class ReusePortServer : public ServerType
+    {
+    public:
+        using ServerType::ServerType;
+
+        /**
+         * @brief Binds config.address and config.port with SO_REUSEPORT on the server's own
+         * io_context. Throws if the port is taken by a socket without SO_REUSEPORT.
+         */
+        void bindReusePort()
+        {
+            namespace asio = SimpleWeb::asio;
+
+            if(!this->io_service)
+            {
+                this->io_service = std::make_shared<asio::io_context>();
+                this->internal_io_service = true;
+            }
+
+            // Without an address, listen dual-stack like SimpleWeb's bind() does.
+            const asio::ip::tcp::endpoint endpoint = this->config.address.empty()
+                ? asio::ip::tcp::endpoint(asio::ip::tcp::v6(), this->config.port)
+                : asio::ip::tcp::endpoint(SimpleWeb::make_address(this->config.address), this->config.port);
+
+            this->acceptor = std::make_unique<asio::ip::tcp::acceptor>(*this->io_service);
+            this->acceptor->open(endpoint.protocol());
+            if(endpoint.protocol() == asio::ip::tcp::v6())
+            {
+                this->acceptor->set_option(asio::ip::v6_only(false));
+            }
+            this->acceptor->set_option(asio::socket_base::reuse_address(true));
+            this->acceptor->set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+            this->acceptor->bind(endpoint);
+
+            this->after_bind();
+        }
+
+        /**
+         * @brief Whether the server has a TCP port, i.e. bind() or bindReusePort() was called.
+         */
+        bool isBound() const
+        {
+            return this->acceptor != nullptr;
+        }
+    };
+
+    /**
+     * @brief Builds [global] acceptors servers with makeServer, which returns a configured
+     * std::unique_ptr<ReusePortServer<...>> with its resources added, and binds them, each on
+     * an io_context of its own. With more than one, they share the port through SO_REUSEPORT.
+     * If unix_socket is set, the first server creates it and the others accept on it as well.
+     * Binding here makes a taken port or path fail startup instead of a server thread.
+     */
+    template<typename MakeServer>
+    auto createServers(const Options& options, MakeServer&& makeServer)
+    {
+        using Server = typename decltype(makeServer())::element_type;
+
+        const unsigned int acceptors = std::max(options.getAcceptors(), 1u);
+        const bool listenTcp = options.getListenTcp();
+        const std::string unixSocket = options.getUnixSocket();
+
+        if(!unixSocket.empty() && !ListensOnUnixSocket<Server>::value)
+        {
+            throw std::invalid_argument("[global] unix_socket is not supported by this server.");
+        }
+        if(!listenTcp && unixSocket.empty())
+        {
+            throw std::invalid_argument("[global] listen_tcp=0 requires a unix_socket.");
+        }
+
+        std::vector<decltype(makeServer())> servers;
+        for(unsigned int i = 0; i < acceptors; ++i)
+        {
+            auto server = makeServer();
+            server->io_service = std::make_shared<SimpleWeb::asio::io_context>();
+            if(listenTcp)
+            {
+                acceptors > 1 ? server->bindReusePort() : static_cast<void>(server->bind());
+            }
+            if constexpr(ListensOnUnixSocket<Server>::value)
+            {
+                if(!unixSocket.empty())
+                {
+                    servers.empty() ? server->bindUnix(unixSocket) : server->shareUnix(*servers.front());
+                }
+            }
+            servers.push_back(std::move(server));
+        }
+
+        if(listenTcp)
+        {
+            LOG_INFO("Listening on port ", options.getPort());
+        }
+        if(!unixSocket.empty())
+        {
+            LOG_INFO("Listening on ", unixSocket);
+        }
+        LOG_INFO(acceptors, " acceptor(s) with ", std::max(servers.front()->config.thread_pool_size, size_t(1)), " I/O thread(s) each");
+
+        return servers;
+    }
+
+    /**
+     * @brief Runs the servers from createServers() until their io_contexts are stopped, with
+     * thread_pool_size threads per server. The threads are started here rather than by
+     * SimpleWeb, so that each can be pinned by Affinity before it touches any memory.
+     */
+    template<typename ServerPtr>
+    void runServers(std::vector<ServerPtr>& servers)
+    {
+        std::vector<std::thread> threads;
+        size_t threadIndex = 0;
+
+        for(auto& server : servers)
+        {
+            if(server->isBound())
+            {
+                server->accept_and_run(); // only starts accepting, since the io_context is external
+            }
+            if constexpr(ListensOnUnixSocket<typename ServerPtr::element_type>::value)
+            {
+                server->acceptUnix();
+            }
+
+            const size_t threadCount = std::max(server->config.thread_pool_size, size_t(1));
+            for(size_t i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back([io = server->io_service, index = threadIndex++]()
+                {
+                    Affinity::instance().pinIoThread(index);
+                    io->run();
+                });
+            }
+        }
+
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "flight.h"
+
+namespace Utils
+{
+    enum class RouteObjective
+    {
+        Cheapest = 0,
+        FewestStops
+    };
+
+    struct RouteQuery
+    {
+        std::string_view origin;
+        std::string_view destination;
+        unsigned int maxLegs = 3;
+        int64_t minConnectionSeconds = 3600; // between one leg's arrival and the next one's departure
+        RouteObjective objective = RouteObjective::Cheapest;
+        size_t limit = 5;                    // itineraries to return, best first
+    };
+
+    struct Itinerary
+    {
+        std::vector<uint32_t> legs; // indices into RouteGraph::flight()
+        int64_t priceTicks = 0;     // in units of 1/flightPriceScale
+        int64_t departureTime = 0;  // Unix seconds
+        int64_t arrivalTime = 0;
+    };
+
+    struct RouteSearchResult
+    {
+        std::vector<Itinerary> itineraries;
+        bool complete = true; // false if the search ran out of budget, so better itineraries may exist
+    };
+
+    /**
+     * An immutable flight network for multi-leg itinerary search, e.g. SOF->LON->FRA when there
+     * is no direct SOF->FRA flight.
+     *
+     * Flights are stored as a compressed sparse row graph: the edges leaving an airport are one
+     * contiguous slice of a single array, sorted by departure time, so the legs which still
+     * make a connection are found with a binary search and scanned without chasing pointers.
+     *
+     * A search is a depth-first branch and bound over at most maxLegs legs. Before it starts,
+     * a backwards pass from the destination computes, for every airport, the fewest legs and
+     * the lowest price to get there ignoring schedules. Those are lower bounds, so any partial
+     * itinerary which cannot reach the destination within the remaining legs, or cannot beat
+     * the worst itinerary kept so far, is cut off right away. Airports are never revisited
+     * within one itinerary, legs must share a currency, and every search stops after a fixed
+     * number of expansions so that a pathological query cannot hold a server thread.
+     */
+    class RouteGraph
+    {
+    public:
+        /**
+         * @brief Throws std::invalid_argument if a flight's times cannot be parsed.
+         */
+        explicit RouteGraph(std::vector<Flight> flights);
+
+        RouteGraph(const RouteGraph&) = delete;
+        RouteGraph& operator=(const RouteGraph&) = delete;
+
+        RouteSearchResult search(const RouteQuery& query) const;
+
+        /**
+         * @brief The result as a JSON object with the itineraries and their legs.
+         */
+        std::string serialize(const RouteSearchResult& result) const;
+
+        const Flight& flight(uint32_t index) const
+        {
+            return _flights[index];
+        }
+
+        size_t airportCount() const
+        {
+            return _airports.size();
+        }
+
+        size_t flightCount() const
+        {
+            return _flights.size();
+        }
+
+    private:
+        static constexpr uint32_t noAirport = std::numeric_limits<uint32_t>::max();
+
+        struct Edge
+        {
+            int64_t departure;
+            int64_t arrival;
+            int64_t price;
+            uint32_t destination;
+            uint32_t flight;
+            uint32_t currency;
+        };
+
+        // The cheapest edge between two airports, for the lower bounds.
+        struct ReverseEdge
+        {
+            uint32_t origin;
+            int64_t price;
+        };
+
+        class Search;
+
+        uint32_t airportIndex(std::string_view code) const;
+
+        std::vector<Flight> _flights;
+        std::vector<std::string> _airports;
+        std::unordered_map<std::string, uint32_t> _airportIndex;
+
+        std::vector<uint32_t> _offsets; // edges of airport a are [_offsets[a], _offsets[a + 1])
+        std::vector<Edge> _edges;
+
+        std::vector<uint32_t> _reverseOffsets;
+        std::vector<ReverseEdge> _reverseEdges;
+    };
+}
@@ -1,15 +1,37 @@
 #pragma once
 
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <memory>
 #include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <strings.h>
 
 // This removes an annoying compilation message.
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS
 #include <boost/json/src.hpp>
-#include <boost/beast/core/detail/base64.hpp>
+#include <openssl/evp.h>
 
 #include "server_https.hpp"
+#include "affinity.h"
+#include "compression.h"
+#include "currency.h"
+#include "decoding.h"
+#include "flight-wire.h"
+#include "ip-filter.h"
+#include "json-reader.h"
 #include "server-exceptions.h"
 #include "options.h"
+#include "logger.h"
+#include "metrics.h"
+#include "tracing.h"
+#include "user-type.h"
 
 namespace Utils
 {
@@ -27,6 +49,7 @@ namespace Utils
             case 403: 	return StatusCode::client_error_forbidden;
             case 404: 	return StatusCode::client_error_not_found;
             case 409: 	return StatusCode::client_error_conflict;
+            case 410: 	return StatusCode::client_error_gone;
             default: 	return StatusCode::server_error_internal_server_error;
         }
     }
@@ -36,6 +59,8 @@ namespace Utils
      */
     void verifyHeaders(const SimpleWeb::CaseInsensitiveMultimap& headers)
     {
+        TRACE_SPAN("verifyHeaders");
+
         auto contentType = headers.find("Content-Type");
         if(contentType == headers.end())
         {
@@ -57,14 +82,20 @@ namespace Utils
     /**
      * Extracts the value of the Authorization header from the request headers.
      * Only accepts the Basic scheme. Throws HttpBadRequest if missing or invalid.
+     * The returned view points into the headers.
      */
-    std::string extractAuthHeader(const SimpleWeb::CaseInsensitiveMultimap& headers)
+    std::string_view extractAuthHeader(const SimpleWeb::CaseInsensitiveMultimap& headers)
     {
+        constexpr std::string_view prefix = "Basic ";
+
         auto authHeader = headers.find("Authorization");
-        const std::string& value = authHeader->second;
-        const std::string prefix = "Basic ";
+        if(authHeader == headers.end())
+        {
+            throw HttpBadRequest("Missing Authorization header.");
+        }
 
-        if (value.substr(0, prefix.size()) != prefix)
+        const std::string_view value = authHeader->second;
+        if(value.substr(0, prefix.size()) != prefix)
         {
             throw HttpBadRequest("Authorization header must use Basic scheme.");
         }
@@ -72,25 +103,130 @@ namespace Utils
         return value.substr(prefix.size());
     }
 
-    std::pair<std::string, std::string> parseBasicAuthCredentials(const SimpleWeb::CaseInsensitiveMultimap& headers)
+    /**
+     * Decoded Basic auth credentials. They live in a fixed buffer inside the object, so
+     * parsing them does not allocate; the views are valid for as long as the object is.
+     */
+    class BasicCredentials
     {
-        std::string encoded = extractAuthHeader(headers);
+    public:
+        static constexpr size_t maxEncodedSize = 256;
 
-        // Decode Base64 using boost::beast::detail::base64::decode
-        std::string decoded;
+        std::string_view username() const
         {
-            std::vector<unsigned char> buf((encoded.size() * 3) / 4 + 1);
-            auto result = boost::beast::detail::base64::decode(buf.data(), encoded.data(), encoded.size());
-            decoded.assign(reinterpret_cast<const char*>(buf.data()), result.first);
+            return { reinterpret_cast<const char*>(_buffer), _usernameLength };
+        }
+
+        std::string_view password() const
+        {
+            return { reinterpret_cast<const char*>(_buffer) + _usernameLength + 1, _passwordLength };
+        }
+
+    private:
+        friend BasicCredentials parseBasicAuthCredentials(const SimpleWeb::CaseInsensitiveMultimap& headers);
+
+        unsigned char _buffer[base64DecodedSize(maxEncodedSize)];
+        size_t _usernameLength = 0;
+        size_t _passwordLength = 0;
+    };
+
+    BasicCredentials parseBasicAuthCredentials(const SimpleWeb::CaseInsensitiveMultimap& headers)
+    {
+        TRACE_SPAN("parseBasicAuthCredentials");
+
+        const std::string_view encoded = extractAuthHeader(headers);
+        if(encoded.size() > BasicCredentials::maxEncodedSize)
+        {
+            throw HttpBadRequest("Basic auth credentials are too long.");
+        }
+
+        BasicCredentials credentials;
+        const ptrdiff_t decodedLength = base64Decode(encoded, credentials._buffer);
+        if(decodedLength < 0)
+        {
+            throw HttpBadRequest("Malformed Basic auth credentials.");
         }
 
         // Split at the first colon
-        auto pos = decoded.find(':');
-        if (pos == std::string::npos)
+        const auto* colon = static_cast<const unsigned char*>(std::memchr(credentials._buffer, ':', decodedLength));
+        if(colon == nullptr)
+        {
             throw HttpBadRequest("Malformed Basic auth credentials.");
-        std::string username = decoded.substr(0, pos);
-        std::string password = decoded.substr(pos + 1);
-        return {username, password};
+        }
+
+        credentials._usernameLength = colon - credentials._buffer;
+        credentials._passwordLength = decodedLength - credentials._usernameLength - 1;
+        return credentials;
+    }
+
+    /**
+     * Finds a parameter in a raw query string and percent-decodes its value into buffer,
+     * without building the map parse_query_string() does. Names are matched
+     * case-insensitively and the first occurrence wins. Returns an empty view if the
+     * parameter is absent. Throws HttpBadRequest if the value does not fit the buffer.
+     */
+    template<size_t N>
+    std::string_view queryParameter(std::string_view query, std::string_view name, char (&buffer)[N])
+    {
+        while(!query.empty())
+        {
+            const size_t ampersand = query.find('&');
+            const std::string_view field = query.substr(0, ampersand);
+            query = ampersand == std::string_view::npos ? std::string_view() : query.substr(ampersand + 1);
+
+            const size_t equals = field.find('=');
+            const std::string_view key = field.substr(0, equals);
+            if(key.size() != name.size() || strncasecmp(key.data(), name.data(), name.size()) != 0)
+            {
+                continue;
+            }
+
+            const std::string_view value = equals == std::string_view::npos ? std::string_view() : field.substr(equals + 1);
+            if(value.size() > N)
+            {
+                throw HttpBadRequest("Query parameter " + std::string(name) + " is too long.");
+            }
+
+            return { buffer, percentDecode(value, buffer, true) };
+        }
+
+        return {};
+    }
+
+    /**
+     * Parses a non-negative integer from a query parameter or header named name.
+     * Throws HttpBadRequest if it is not a number.
+     */
+    uint64_t parseUnsigned(std::string_view value, std::string_view name)
+    {
+        uint64_t result = 0;
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if(value.empty() || error != std::errc() || end != value.data() + value.size())
+        {
+            throw HttpBadRequest(std::string(name) + " must be a non-negative integer.");
+        }
+
+        return result;
+    }
+
+    /**
+     * Like parseUnsigned(), returning defaultValue if the query parameter is absent.
+     */
+    uint64_t unsignedQueryParameter(std::string_view query, std::string_view name, uint64_t defaultValue)
+    {
+        char buffer[24];
+        const std::string_view value = queryParameter(query, name, buffer);
+        return value.empty() ? defaultValue : parseUnsigned(value, name);
+    }
+
+    /**
+     * Decodes %XX escapes in a request path.
+     */
+    std::string decodeHexSymbols(std::string_view input)
+    {
+        std::string decoded(input.size(), '\0');
+        decoded.resize(percentDecode(input, decoded.data()));
+        return decoded;
     }
 
     std::string hashPasswordSHA256(const std::string& password)
@@ -128,16 +264,558 @@ namespace Utils
         server.config.timeout_request = options.getTimeoutRequest();
     }
 
+    /**
+     * Applies the [affinity] options and logs the CPU topology. Call before startLogging(),
+     * since it confines the calling thread to worker_cpus and every thread started later
+     * inherits that, the log writer included. I/O threads are pinned by runServers().
+     */
+    void startAffinity(const Options& options)
+    {
+        auto& affinity = Affinity::instance();
+        affinity.configure(options.getIoCpus(), options.getWorkerCpus(), options.getNumaLocal());
+        affinity.pinWorkerThread();
+
+        LOG_INFO(affinity.report());
+    }
+
+    /**
+     * Loads security.blacklisted_ips into the IpFilter. Throws std::invalid_argument if an
+     * entry is not an IP address or CIDR range.
+     */
+    void startIpFilter(const Options& options)
+    {
+        const auto blacklistedIPs = options.getBlacklistedIPs();
+        IpFilter::instance().replace(std::make_shared<const CidrTrie>(std::vector<std::string>(blacklistedIPs.begin(), blacklistedIPs.end())));
+    }
+
+    /**
+     * Applies the [logging] options and starts the background log writer.
+     */
+    void startLogging(const Options& options)
+    {
+        auto& logger = Logger::instance();
+        logger.configure(options.getLogLevel(), options.getDebugSampleRate());
+        logger.start();
+    }
+
+    /**
+     * Applies the [tracing] options.
+     */
+    void startTracing(const Options& options)
+    {
+        Tracer::instance().configure(options.getTraceRingSize(),
+                                     options.getTraceSampleRate(),
+                                     options.getTraceSlowRequestMs(),
+                                     options.getTraceOutputDir());
+    }
+
+    /**
+     * Applies the [compression] options.
+     */
+    void startCompression(const Options& options)
+    {
+        Compressor::instance().configure(options.getCompressionLevel(),
+                                         options.getCompressionMinSize(),
+                                         options.getCompressionCacheEntries());
+    }
+
+    /**
+     * Applies the [currency] options.
+     */
+    void startCurrency(const Options& options)
+    {
+        ExchangeRates::instance().configure(options.getExchangeRates());
+    }
+
+    /**
+     * The encoding a compressible response to this request would use, ignoring min_size.
+     */
     template<typename RequestType>
-    void validateNotBlacklisted(std::shared_ptr<RequestType> request, const std::set<std::string>& blacklistedIPs)
+    ContentEncoding acceptedEncoding(const RequestType& request)
     {
-        if (blacklistedIPs.empty())
+        if(!Compressor::instance().isEnabled())
+        {
+            return ContentEncoding::Identity;
+        }
+
+        const auto acceptEncoding = request.header.find("Accept-Encoding");
+        return acceptEncoding == request.header.end() ? ContentEncoding::Identity : negotiateEncoding(acceptEncoding->second);
+    }
+
+    /**
+     * Writes a 200 response, compressed with gzip or deflate if the client accepts one of
+     * them and the body reaches [compression] min_size. Vary is sent whenever compression is
+     * enabled, also for bodies below min_size, so that it matches the 304 of writeVersioned().
+     */
+    template<typename ResponseType, typename RequestType>
+    void writeCompressible(ResponseType& response, const RequestType& request, std::string_view body,
+                           SimpleWeb::CaseInsensitiveMultimap headers = {})
+    {
+        auto& compressor = Compressor::instance();
+        if(compressor.isEnabled())
+        {
+            headers.emplace("Vary", "Accept-Encoding");
+
+            const ContentEncoding encoding = body.size() >= compressor.minSize() ? acceptedEncoding(request) : ContentEncoding::Identity;
+            if(encoding != ContentEncoding::Identity)
+            {
+                const auto compressed = compressor.compress(body, encoding);
+                headers.emplace("Content-Encoding", std::string(getContentEncodingName(encoding)));
+                response.write(SimpleWeb::StatusCode::success_ok, *compressed, headers);
+                return;
+            }
+        }
+
+        response.write(SimpleWeb::StatusCode::success_ok, body, headers);
+    }
+
+    /**
+     * The flight format a request asks for in its Accept header, see flight-wire.h.
+     */
+    template<typename RequestType>
+    FlightFormat requestedFlightFormat(const RequestType& request)
+    {
+        const auto accept = request.header.find("Accept");
+        return accept == request.header.end() ? FlightFormat::Json : negotiateFlightFormat(accept->second);
+    }
+
+    /**
+     * The currency a request asks prices to be converted to, or an empty view for the stored
+     * ones. Throws HttpBadRequest if there is no exchange rate for it.
+     */
+    template<size_t N>
+    std::string_view requestedCurrency(std::string_view query, char (&buffer)[N])
+    {
+        const std::string_view currency = queryParameter(query, "currency", buffer);
+        if(!currency.empty() && !ExchangeRates::instance().knows(currency))
+        {
+            throw HttpBadRequest("Unknown currency " + std::string(currency) + ".");
+        }
+
+        return currency;
+    }
+
+    /**
+     * The headers of a flights response in the given format. Vary tells caches that the
+     * Accept header picks it.
+     */
+    SimpleWeb::CaseInsensitiveMultimap flightResponseHeaders(FlightFormat format)
+    {
+        return {
+            { "Content-Type", format == FlightFormat::Binary ? std::string(flightWireMediaType) : std::string("application/json") },
+            { "Vary", "Accept" }
+        };
+    }
+
+    /**
+     * Whether an If-None-Match header value lists etag, using the weak comparison RFC 9110
+     * requires for it.
+     */
+    bool ifNoneMatchHits(std::string_view ifNoneMatch, std::string_view etag)
+    {
+        while(!ifNoneMatch.empty())
+        {
+            const size_t comma = ifNoneMatch.find(',');
+            std::string_view candidate = ifNoneMatch.substr(0, comma);
+            ifNoneMatch = comma == std::string_view::npos ? std::string_view() : ifNoneMatch.substr(comma + 1);
+
+            while(!candidate.empty() && candidate.front() == ' ')
+            {
+                candidate.remove_prefix(1);
+            }
+            while(!candidate.empty() && candidate.back() == ' ')
+            {
+                candidate.remove_suffix(1);
+            }
+            if(candidate.substr(0, 2) == "W/")
+            {
+                candidate.remove_prefix(2);
+            }
+
+            if(candidate == etag || candidate == "*")
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Answers a GET whose body only changes together with versionTag, see
+     * StorageProvider::versionTag(). A client which already holds the current representation
+     * gets a 304 and makeBody is never called; anyone else gets the body with an ETag.
+     * The tag names the negotiated encoding too, since each encoding is its own representation.
+     * headers, e.g. a Content-Type, are sent with both.
+     */
+    template<typename ResponseType, typename RequestType, typename MakeBody>
+    void writeVersioned(ResponseType& response, const RequestType& request, std::string_view versionTag, MakeBody&& makeBody,
+                        SimpleWeb::CaseInsensitiveMultimap headers = {})
+    {
+        const std::string_view encodingName = getContentEncodingName(acceptedEncoding(request));
+
+        std::string etag;
+        etag.reserve(versionTag.size() + encodingName.size() + 3);
+        etag += '"';
+        etag += versionTag;
+        etag += '-';
+        etag += encodingName;
+        etag += '"';
+
+        headers.emplace("ETag", etag);
+
+        const auto ifNoneMatch = request.header.find("If-None-Match");
+        if(ifNoneMatch != request.header.end() && ifNoneMatchHits(ifNoneMatch->second, etag))
+        {
+            TRACE_SPAN("notModified");
+            if(Compressor::instance().isEnabled())
+            {
+                headers.emplace("Vary", "Accept-Encoding");
+            }
+
+            // Written by hand, since Response::write() would add a Content-Length, which on a
+            // 304 claims the length of the body it stands in for (RFC 9110, section 8.6).
+            response << "HTTP/1.1 " << SimpleWeb::status_code(SimpleWeb::StatusCode::redirection_not_modified) << "\r\n";
+            for(const auto& [name, value] : headers)
+            {
+                response << name << ": " << value << "\r\n";
+            }
+            response << "\r\n";
             return;
+        }
+
+        writeCompressible(response, request, makeBody(), std::move(headers));
+    }
+
+    /**
+     * Blocked clients are normally turned away when they connect, see FilteringHttpServer.
+     * This catches keep-alive connections which were accepted before their address was blocked.
+     */
+    template<typename RequestType>
+    void validateNotBlacklisted(std::shared_ptr<RequestType> request)
+    {
+        TRACE_SPAN("validateNotBlacklisted");
 
-        auto remoteEndpoint = request->remote_endpoint_address();
-        if (blacklistedIPs.find(remoteEndpoint) != blacklistedIPs.end())
+        // Unspecified for clients on the Unix socket, which are local and never filtered.
+        const auto address = request->remote_endpoint().address();
+        if(!address.is_unspecified() && IpFilter::instance().blocks(address))
+        {
+            throw HttpForbidden("IP address " + address.to_string() + " is blacklisted.");
+        }
+    }
+
+    /**
+     * Reads the status code back from the status line of a response the handler has already
+     * written. Returns 0 when nothing is buffered, e.g. if the handler sent the response itself.
+     */
+    template<typename ResponseType>
+    int responseStatusCode(ResponseType& response)
+    {
+        const auto* streambuf = dynamic_cast<SimpleWeb::asio::streambuf*>(response.rdbuf());
+        char statusLine[12]; // "HTTP/1.1 200"
+        if(!streambuf || streambuf->size() < sizeof(statusLine))
         {
-            throw HttpForbidden("IP address " + remoteEndpoint + " is blacklisted.");
+            return 0;
         }
+
+        SimpleWeb::asio::buffer_copy(SimpleWeb::asio::buffer(statusLine), streambuf->data());
+        if(std::memcmp(statusLine, "HTTP/", 5) != 0)
+        {
+            return 0;
+        }
+
+        return (statusLine[9] - '0') * 100 + (statusLine[10] - '0') * 10 + (statusLine[11] - '0');
+    }
+
+    template<typename ServerType>
+    using ResourceHandler = std::function<void(std::shared_ptr<typename ServerType::Response>,
+                                               std::shared_ptr<typename ServerType::Request>)>;
+
+    /**
+     * Records a request whose handler answers after returning, e.g. when a long poll fires or
+     * a stream ends. Obtained through deferCompletion(). A request that is never finished,
+     * because the client went away, is recorded with status 0 once the last reference is gone.
+     */
+    class RequestCompletion
+    {
+    public:
+        RequestCompletion(RouteMetrics& metrics, DeferredRequestTrace trace, std::chrono::steady_clock::time_point start)
+            : _metrics(metrics),
+              _trace(trace),
+              _start(start) {}
+
+        ~RequestCompletion()
+        {
+            finish(0, 0);
+        }
+
+        RequestCompletion(const RequestCompletion&) = delete;
+        RequestCompletion& operator=(const RequestCompletion&) = delete;
+
+        /**
+         * @brief Records the request as answered now. Only the first call has an effect.
+         */
+        void finish(int statusCode, size_t bytes)
+        {
+            if(_finished.exchange(true, std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            _metrics.end(statusCode, std::chrono::steady_clock::now() - _start, bytes);
+            _trace.finish();
+        }
+
+    private:
+        RouteMetrics& _metrics;
+        DeferredRequestTrace _trace;
+        const std::chrono::steady_clock::time_point _start;
+        std::atomic<bool> _finished { false };
+    };
+
+    /**
+     * The instrumented request being handled on the calling thread.
+     */
+    struct PendingRequest
+    {
+        RouteMetrics& metrics;
+        RequestTrace& trace;
+        const std::chrono::steady_clock::time_point start;
+        std::shared_ptr<RequestCompletion> completion;
+    };
+
+    PendingRequest*& currentPendingRequest()
+    {
+        thread_local PendingRequest* pending = nullptr;
+        return pending;
+    }
+
+    /**
+     * @brief Called from an instrumented handler that answers after returning, so that the
+     * request is recorded when the returned completion is finished instead of on return.
+     */
+    std::shared_ptr<RequestCompletion> deferCompletion()
+    {
+        PendingRequest* pending = currentPendingRequest();
+        if(!pending)
+        {
+            throw std::logic_error("deferCompletion() called outside of an instrumented handler.");
+        }
+
+        if(!pending->completion)
+        {
+            pending->completion = std::make_shared<RequestCompletion>(pending->metrics, pending->trace.defer(), pending->start);
+        }
+        return pending->completion;
+    }
+
+    /**
+     * Wraps a handler so that its latency, status code and response size are recorded
+     * under the given method and route, and so that it is traced as one request.
+     * Handlers that answer asynchronously report completion through deferCompletion().
+     */
+    template<typename ServerType>
+    ResourceHandler<ServerType> instrument(const std::string& method, const std::string& route, ResourceHandler<ServerType> handler)
+    {
+        RouteMetrics& metrics = Metrics::instance().route(method, route);
+
+        return [&metrics, handler = std::move(handler)](std::shared_ptr<typename ServerType::Response> response,
+                                                        std::shared_ptr<typename ServerType::Request> request)
+        {
+            RequestTrace trace(metrics.route().c_str());
+            PendingRequest pending { metrics, trace, std::chrono::steady_clock::now(), nullptr };
+            metrics.begin();
+
+            currentPendingRequest() = &pending;
+            try
+            {
+                handler(response, request);
+            }
+            catch(...)
+            {
+                currentPendingRequest() = nullptr;
+                if(pending.completion)
+                {
+                    pending.completion->finish(500, 0);
+                }
+                else
+                {
+                    metrics.end(500, std::chrono::steady_clock::now() - pending.start, 0);
+                }
+                throw;
+            }
+            currentPendingRequest() = nullptr;
+
+            if(!pending.completion)
+            {
+                metrics.end(responseStatusCode(*response), std::chrono::steady_clock::now() - pending.start, response->size());
+            }
+        };
+    }
+
+    /**
+     * Registers an instrumented handler. Every route should be added through here.
+     */
+    template<typename ServerType, typename Handler>
+    void addResource(ServerType& server, const std::string& route, const std::string& method, Handler&& handler)
+    {
+        server.resource[route][method] = instrument<ServerType>(method, route, std::forward<Handler>(handler));
+    }
+
+    template<typename ServerType, typename Handler>
+    void addDefaultResource(ServerType& server, const std::string& method, Handler&& handler)
+    {
+        server.default_resource[method] = instrument<ServerType>(method, "default", std::forward<Handler>(handler));
+    }
+
+    /**
+     * Exposes every registered metric on GET /metrics in the Prometheus text format.
+     */
+    template<typename ServerType>
+    void addMetricsResource(ServerType& server)
+    {
+        addResource(server, "^/metrics$", "GET", [](std::shared_ptr<typename ServerType::Response> response,
+                                                    std::shared_ptr<typename ServerType::Request> request)
+        {
+            try
+            {
+                validateNotBlacklisted(request);
+
+                SimpleWeb::CaseInsensitiveMultimap headers = { { "Content-Type", "text/plain; version=0.0.4" } };
+                response->write(Metrics::instance().renderPrometheus(), headers);
+            }
+            catch(const HttpException& e)
+            {
+                response->write(extractErrorCode(e), e.what());
+            }
+        });
+    }
+
+    /**
+     * Dumps the spans currently held by every thread on GET /debug/trace, in the Chrome trace
+     * event format. Save the response and open it in chrome://tracing or Perfetto.
+     */
+    template<typename ServerType>
+    void addTraceResource(ServerType& server)
+    {
+        addResource(server, "^/debug/trace$", "GET", [](std::shared_ptr<typename ServerType::Response> response,
+                                                        std::shared_ptr<typename ServerType::Request> request)
+        {
+            try
+            {
+                validateNotBlacklisted(request);
+
+                if(!Tracer::instance().isEnabled())
+                {
+                    throw HttpNotFound("Tracing is disabled, set [tracing] ring_size in config.ini.");
+                }
+
+                SimpleWeb::CaseInsensitiveMultimap headers = { { "Content-Type", "application/json" } };
+                response->write(Tracer::instance().dumpChromeTrace(), headers);
+            }
+            catch(const HttpException& e)
+            {
+                response->write(extractErrorCode(e), e.what());
+            }
+        });
+    }
+
+    /**
+     * The IP blocklist on /admin/ip-filter, for managers and admins, like the other write
+     * endpoints. GET lists the blocked ranges and
+     * PUT replaces them with a JSON array such as ["10.0.0.0/8", "2001:db8::/32"]. The new list
+     * is swapped in atomically and applies to the next connection or request, without a restart.
+     */
+    template<typename ServerType, typename Provider>
+    void addIpFilterResource(ServerType& server, std::shared_ptr<Provider> provider)
+    {
+        using Response = typename ServerType::Response;
+        using Request = typename ServerType::Request;
+
+        const auto authorize = [provider](const Request& request)
+        {
+            const BasicCredentials credentials = parseBasicAuthCredentials(request.header);
+            if(!provider->isAuthenticated(credentials.username(), credentials.password()))
+            {
+                throw HttpUnauthorized("Invalid username or password.");
+            }
+
+            if(!provider->isAuthorized(credentials.username(), UserType::Manager) &&
+               !provider->isAuthorized(credentials.username(), UserType::Admin))
+            {
+                throw HttpForbidden("User " + std::string(credentials.username()) + " is not authorized to perform this action.");
+            }
+        };
+
+        const auto writeEntries = [](Response& response)
+        {
+            boost::json::array entries;
+            for(const std::string& entry : IpFilter::instance().current()->entries())
+            {
+                entries.emplace_back(entry);
+            }
+
+            SimpleWeb::CaseInsensitiveMultimap headers = { { "Content-Type", "application/json" } };
+            response.write(boost::json::serialize(entries), headers);
+        };
+
+        addResource(server, "^/admin/ip-filter$", "GET", [authorize, writeEntries](std::shared_ptr<Response> response,
+                                                                                  std::shared_ptr<Request> request)
+        {
+            try
+            {
+                validateNotBlacklisted(request);
+                authorize(*request);
+                writeEntries(*response);
+            }
+            catch(const HttpException& e)
+            {
+                response->write(extractErrorCode(e), e.what());
+            }
+        });
+
+        addResource(server, "^/admin/ip-filter$", "PUT", [authorize, writeEntries](std::shared_ptr<Response> response,
+                                                                                  std::shared_ptr<Request> request)
+        {
+            try
+            {
+                validateNotBlacklisted(request);
+                verifyHeaders(request->header);
+                authorize(*request);
+
+                const JsonDocument document(request->content.string());
+                if(!document.root().is_array())
+                {
+                    throw HttpBadRequest("Expected a JSON array of IP addresses and CIDR ranges.");
+                }
+
+                std::vector<std::string> entries;
+                for(const boost::json::value& entry : document.root().get_array())
+                {
+                    if(!entry.is_string())
+                    {
+                        throw HttpBadRequest("Expected a JSON array of IP addresses and CIDR ranges.");
+                    }
+                    entries.emplace_back(entry.get_string());
+                }
+
+                std::shared_ptr<const CidrTrie> trie;
+                try
+                {
+                    trie = std::make_shared<const CidrTrie>(entries);
+                }
+                catch(const std::invalid_argument& e)
+                {
+                    throw HttpBadRequest(e.what());
+                }
+
+                IpFilter::instance().replace(std::move(trie));
+                writeEntries(*response);
+            }
+            catch(const HttpException& e)
+            {
+                response->write(extractErrorCode(e), e.what());
+            }
+        });
     }
-}
\ No newline at end of file
+}
@@ -52,6 +52,14 @@ namespace Utils
         int errorCode() const noexcept override { return 409; }
     };
 
+    class HttpGone : public HttpException
+    {
+    public:
+        HttpGone(const std::string& msg) : HttpException(msg) {}
+
+        int errorCode() const noexcept override { return 410; }
+    };
+
     class HttpInternalServerError : public HttpException
     {
     public:
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "flight.h"
+#include "pair.h"
+#include "user.h"
+#include "user-type.h"
+
+namespace Utils
+{
+    class Options;
+
+    enum class Table
+    {
+        Users,
+        Pairs,
+        Flights
+    };
+
+    constexpr std::string_view getTableName(const Table val)
+    {
+        switch(val)
+        {
+            case Table::Users:  return "users";
+            case Table::Pairs:  return "pairs";
+            default:            return "flights";
+        }
+    }
+
+    /**
+     * One page of a keyset listing. Pages are cut by primary key rather than by offset, so
+     * every page costs an index range scan of its own size no matter how deep into the table
+     * it starts.
+     */
+    template<typename Record>
+    struct Page
+    {
+        std::vector<Record> records;
+        uint64_t lastId = 0;  // the primary key of the last record, the next page's afterId
+        bool hasMore = false; // whether there are records after lastId
+    };
+
+    /**
+     * Everything the servers read from and write to their database. Implementations must be
+     * safe to call from any number of server threads concurrently.
+     *
+     * The *Unsafe methods exist for the SQL injection demonstrations. Backends which build SQL
+     * statements implement them through string concatenation, others treat them like their
+     * safe counterparts.
+     */
+    class Storage
+    {
+    public:
+        virtual ~Storage() = default;
+
+        virtual bool isAuthenticated(std::string_view username, std::string_view password) = 0;
+        virtual bool isAuthorized(std::string_view username, UserType userType) = 0;
+
+        virtual void insertUser(const User& user) = 0;
+        virtual void insertUserUnsafe(const User& user) = 0;
+
+        /**
+         * @brief Throws HttpStateConflict if a pair with the same origin and destination exists.
+         */
+        virtual void insertPair(const Pair& pair) = 0;
+
+        /**
+         * @brief Inserts a batch of users atomically, skipping those whose username is taken,
+         * either already or earlier in the same batch. Returns whether each user was inserted.
+         */
+        virtual std::vector<bool> insertUsers(const std::vector<User>& users) = 0;
+
+        /**
+         * @brief Like insertUsers(), for pairs with the same origin and destination.
+         */
+        virtual std::vector<bool> insertPairs(const std::vector<Pair>& pairs) = 0;
+
+        virtual std::vector<User> getUsers() = 0;
+        virtual std::vector<Pair> getPairs() = 0;
+
+        /**
+         * @brief Up to limit users with a primary key greater than afterId, in key order.
+         */
+        virtual Page<User> getUsersPage(uint64_t afterId, size_t limit) = 0;
+
+        /**
+         * @brief Like getUsersPage(), for pairs.
+         */
+        virtual Page<Pair> getPairsPage(uint64_t afterId, size_t limit) = 0;
+        virtual std::optional<Pair> getPair(const std::string& origin, const std::string& destination) = 0;
+        virtual std::vector<Pair> getPairsUnsafe(const std::string& origin, const std::string& destination) = 0;
+
+        /**
+         * @brief An empty origin or destination matches any.
+         */
+        virtual std::vector<Flight> getFlights(const std::string& origin, const std::string& destination) = 0;
+
+        /**
+         * @brief Like getUsersPage(), for flights. Flights are only ever inserted, so paging
+         * on from the last key seen returns exactly the flights added since.
+         */
+        virtual Page<Flight> getFlightsPage(uint64_t afterId, size_t limit) = 0;
+
+        /**
+         * @brief Adds one flight, built by makeFlight, for every pair which has none yet.
+         */
+        virtual void insertMissingFlights(const std::function<Flight(const Pair&)>& makeFlight) = 0;
+
+        /**
+         * @brief A counter which grows by one for every row inserted, updated or deleted. Only
+         * meaningful when compared to an earlier read, e.g. to tell whether a cached response
+         * is still current, or how many rows changed at most since.
+         */
+        virtual uint64_t getTableVersion(Table table) = 0;
+    };
+
+    /**
+     * @brief Creates the backend selected by [storage] backend in config.ini, either mysql or
+     * memory. Throws std::invalid_argument for anything else.
+     */
+    std::shared_ptr<Storage> createStorage(const Options& options);
+
+    /**
+     * @brief A made-up flight for the pair, departing within a week of 2021-01-01 at a random
+     * price and cabin. Seeds the flights table, which nothing else fills.
+     */
+    Flight makeSeedFlight(const Pair& pair);
+
+    /**
+     * The common base of the server Providers, which turn storage results into responses.
+     */
+    class StorageProvider
+    {
+    public:
+        explicit StorageProvider(std::shared_ptr<Storage> storage) : _storage(std::move(storage)) {}
+
+        StorageProvider(const StorageProvider&) = delete;
+        StorageProvider& operator=(const StorageProvider&) = delete;
+
+        bool isAuthenticated(std::string_view username, std::string_view password)
+        {
+            return _storage->isAuthenticated(username, password);
+        }
+
+        bool isAuthorized(std::string_view username, UserType userType)
+        {
+            return _storage->isAuthorized(username, userType);
+        }
+
+        /**
+         * @brief Gives every pair without flights a seed flight, see makeSeedFlight().
+         */
+        void populateFlightsTable()
+        {
+            _storage->insertMissingFlights(makeSeedFlight);
+        }
+
+        /**
+         * @brief Joins the versions of the tables a response is built from, e.g. "12.3", for
+         * use in an ETag. The tag changes whenever any of the tables does.
+         */
+        std::string versionTag(std::initializer_list<Table> tables)
+        {
+            std::string tag;
+            for(const Table table : tables)
+            {
+                if(!tag.empty())
+                {
+                    tag += '.';
+                }
+                tag += std::to_string(_storage->getTableVersion(table));
+            }
+            return tag;
+        }
+
+    protected:
+        const std::shared_ptr<Storage> _storage;
+    };
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+    struct TraceEvent
+    {
+        const char* name; // must point to a string literal
+        uint64_t requestId;
+        int64_t startNanos;
+        int64_t durationNanos;
+    };
+
+    /**
+     * Collects timed spans into per-thread ring buffers and exports them in the Chrome trace
+     * event format, which chrome://tracing and Perfetto open directly.
+     *
+     * Spans are only recorded while tracing is enabled, and the oldest spans of a thread are
+     * overwritten once its ring is full. Every request gets an id, and when a request is sampled
+     * or slower than the configured threshold its spans are written to
+     * <output_dir>/trace-<id>.json as soon as it finishes. The whole contents of all rings can
+     * also be dumped on demand.
+     */
+    class Tracer
+    {
+    public:
+        static Tracer& instance();
+
+        Tracer(const Tracer&) = delete;
+        Tracer& operator=(const Tracer&) = delete;
+
+        /**
+         * @brief A ringSize of 0 disables tracing. A sampleRate of N captures every N-th request,
+         * 0 captures none. A slowRequestMs of 0 disables capturing slow requests.
+         * Must be called before any span is recorded.
+         */
+        void configure(unsigned int ringSize, unsigned int sampleRate, unsigned int slowRequestMs, const std::string& outputDir);
+
+        bool isEnabled() const
+        {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        int64_t now() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _epoch).count();
+        }
+
+        void record(const TraceEvent& event);
+
+        uint64_t nextRequestId()
+        {
+            return _nextRequestId.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Writes the request's spans to a file if it was sampled or slow.
+         */
+        void finishRequest(uint64_t requestId, int64_t durationNanos);
+
+        /**
+         * @brief Renders every span currently held in any thread's ring.
+         */
+        std::string dumpChromeTrace();
+
+    private:
+        class Ring;
+
+        Tracer() = default;
+
+        Ring& localRing();
+
+        const std::chrono::steady_clock::time_point _epoch = std::chrono::steady_clock::now();
+
+        void writeCapture(uint64_t requestId, const std::vector<TraceEvent>& events, unsigned int threadIndex);
+
+        std::atomic<bool> _enabled { false };
+        size_t _ringSize = 0;
+        unsigned int _sampleRate = 0;
+        int64_t _slowRequestNanos = 0;
+        std::string _outputDir;
+        std::atomic<uint64_t> _nextRequestId { 1 };
+
+        std::mutex _ringsMutex;
+        std::vector<std::shared_ptr<Ring>> _rings;
+        unsigned int _nextThreadIndex = 0;
+    };
+
+    /**
+     * The id of the request being handled on the calling thread, 0 outside of requests.
+     */
+    uint64_t& currentTraceRequestId();
+
+    /**
+     * Times the enclosing scope. Use through TRACE_SPAN.
+     */
+    class TraceSpan
+    {
+    public:
+        explicit TraceSpan(const char* name)
+            : _name(name),
+              _start(Tracer::instance().isEnabled() ? Tracer::instance().now() : -1) {}
+
+        ~TraceSpan()
+        {
+            if(_start >= 0)
+            {
+                auto& tracer = Tracer::instance();
+                tracer.record(TraceEvent { _name, currentTraceRequestId(), _start, tracer.now() - _start });
+            }
+        }
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+    private:
+        const char* _name;
+        const int64_t _start;
+    };
+
+    /**
+     * The end of a request that outlives the scope it started in, see RequestTrace::defer().
+     */
+    class DeferredRequestTrace
+    {
+    public:
+        DeferredRequestTrace() = default;
+
+        DeferredRequestTrace(const char* route, uint64_t requestId, int64_t start)
+            : _route(route),
+              _requestId(requestId),
+              _start(start) {}
+
+        /**
+         * @brief Records the request as ending now. Only the first call has an effect.
+         */
+        void finish()
+        {
+            if(_start >= 0)
+            {
+                auto& tracer = Tracer::instance();
+                const int64_t duration = tracer.now() - _start;
+
+                tracer.record(TraceEvent { _route, _requestId, _start, duration });
+                tracer.finishRequest(_requestId, duration);
+                _start = -1;
+            }
+        }
+
+    private:
+        const char* _route = nullptr;
+        uint64_t _requestId = 0;
+        int64_t _start = -1;
+    };
+
+    /**
+     * Marks the enclosing scope as one request. Spans recorded on this thread until it ends
+     * are attributed to the request.
+     */
+    class RequestTrace
+    {
+    public:
+        explicit RequestTrace(const char* route)
+            : _route(route),
+              _start(Tracer::instance().isEnabled() ? Tracer::instance().now() : -1)
+        {
+            if(_start >= 0)
+            {
+                currentTraceRequestId() = Tracer::instance().nextRequestId();
+            }
+        }
+
+        ~RequestTrace()
+        {
+            if(_start >= 0 && _deferred)
+            {
+                currentTraceRequestId() = 0;
+            }
+            else if(_start >= 0)
+            {
+                auto& tracer = Tracer::instance();
+                const uint64_t requestId = currentTraceRequestId();
+                const int64_t duration = tracer.now() - _start;
+
+                tracer.record(TraceEvent { _route, requestId, _start, duration });
+                currentTraceRequestId() = 0;
+                tracer.finishRequest(requestId, duration);
+            }
+        }
+
+        RequestTrace(const RequestTrace&) = delete;
+        RequestTrace& operator=(const RequestTrace&) = delete;
+
+        /**
+         * @brief For requests answered after the scope ends: the scope then only stops
+         * attributing spans, and the request is recorded when the result is finished.
+         */
+        DeferredRequestTrace defer()
+        {
+            _deferred = true;
+            return _start >= 0 ? DeferredRequestTrace(_route, currentTraceRequestId(), _start) : DeferredRequestTrace();
+        }
+
+    private:
+        const char* _route;
+        const int64_t _start;
+        bool _deferred = false;
+    };
+}
+
+#define UTILS_TRACE_CONCAT_IMPL(a, b) a##b
+#define UTILS_TRACE_CONCAT(a, b) UTILS_TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SPAN(name) Utils::TraceSpan UTILS_TRACE_CONCAT(utilsTraceSpan, __LINE__)(name)
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "server_http.hpp"
+
+namespace Utils
+{
+    /**
+     * An HTTP server which also accepts connections on a Unix domain socket, for clients on
+     * the same host. They skip the TCP stack entirely: no loopback routing, checksums,
+     * congestion control or Nagle, just a copy between two socket buffers.
+     *
+     * SimpleWeb only knows TCP sockets, so accepted Unix sockets are handed to it as if they
+     * were TCP ones. Everything a request handler does works the same over both, except that
+     * remote_endpoint() is unspecified for Unix connections.
+     */
+    template<typename ServerType>
+    class UnixSocketServer : public ServerType
+    {
+    public:
+        using ServerType::ServerType;
+
+        ~UnixSocketServer()
+        {
+            if(!_unixPath.empty())
+            {
+                ::unlink(_unixPath.c_str());
+            }
+        }
+
+        /**
+         * @brief Listens on path, replacing a socket file left behind by an earlier run.
+         * Throws if the path is taken by anything else.
+         */
+        void bindUnix(const std::string& path)
+        {
+            struct stat status;
+            if(::lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+            {
+                ::unlink(path.c_str());
+            }
+
+            _unixAcceptor = std::make_unique<Protocol::acceptor>(*this->io_service);
+            _unixAcceptor->open(Protocol());
+            _unixAcceptor->bind(Protocol::endpoint(path));
+            _unixAcceptor->listen();
+            // A server whose accept4() loses the race for a connection must not block.
+            _unixAcceptor->native_non_blocking(true);
+            _unixPath = path;
+        }
+
+        /**
+         * @brief Accepts on the socket bound by another server too, on this server's
+         * io_context. Unix sockets have no SO_REUSEPORT balancing, so the servers take turns
+         * on one listening socket instead.
+         */
+        void shareUnix(const UnixSocketServer& other)
+        {
+            const int fd = ::dup(other._unixAcceptor->native_handle());
+            if(fd < 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "Failed to share the Unix socket");
+            }
+
+            _unixAcceptor = std::make_unique<Protocol::acceptor>(*this->io_service, Protocol(), fd);
+        }
+
+        /**
+         * @brief Starts accepting Unix connections, if bindUnix() or shareUnix() was called.
+         */
+        void acceptUnix()
+        {
+            if(!_unixAcceptor)
+            {
+                return;
+            }
+
+            _unixAcceptor->async_wait(Protocol::acceptor::wait_read, [this](const SimpleWeb::error_code& ec)
+            {
+                if(ec == SimpleWeb::error::operation_aborted)
+                {
+                    return;
+                }
+
+                if(!ec)
+                {
+                    // Fails with EAGAIN when another server sharing the socket was faster.
+                    const int fd = ::accept4(_unixAcceptor->native_handle(), nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                    if(fd >= 0)
+                    {
+                        startSession(fd);
+                    }
+                }
+
+                acceptUnix();
+            });
+        }
+
+    private:
+        using Protocol = SimpleWeb::asio::local::stream_protocol;
+
+        void startSession(int fd)
+        {
+            auto connection = this->create_connection(*this->io_service);
+
+            SimpleWeb::error_code ec;
+            connection->socket->assign(SimpleWeb::asio::ip::tcp::v6(), fd, ec);
+            if(ec)
+            {
+                ::close(fd);
+                return;
+            }
+
+            this->read(std::make_shared<typename ServerType::Session>(this->config.max_request_streambuf_size, connection));
+        }
+
+        std::unique_ptr<Protocol::acceptor> _unixAcceptor;
+        std::string _unixPath; // only set on the server which created the socket file
+    };
+
+    /**
+     * @brief Whether Server can listen on a Unix domain socket, i.e. derives from UnixSocketServer.
+     */
+    template<typename Server, typename = void>
+    struct ListensOnUnixSocket : std::false_type {};
+
+    template<typename Server>
+    struct ListensOnUnixSocket<Server, std::void_t<decltype(std::declval<Server&>().acceptUnix())>> : std::true_type {};
+}
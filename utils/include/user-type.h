@@ -1,7 +1,6 @@
 #pragma once
 
-#include <string>
-#include <unordered_map>
+#include <string_view>
 
 namespace Utils
 {
@@ -13,16 +12,16 @@ namespace Utils
         Admin = 4
     };
 
-    static const std::unordered_map<UserType, std::string> userTypes = {
-        { UserType::External,   "external" },
-        { UserType::Internal,   "internal" },
-        { UserType::Manager,    "manager" },
-        { UserType::Admin,      "admin" }
-    };
-
-    inline std::string getUserTypeString(const UserType val)
+    constexpr std::string_view getUserTypeString(const UserType val)
     {
-        auto it = userTypes.find(val);
-        return it != userTypes.end() ? it->second : "unknown";
+        switch(val)
+        {
+            case UserType::External:    return "external";
+            case UserType::Internal:    return "internal";
+            case UserType::Manager:     return "manager";
+            case UserType::Admin:       return "admin";
+        }
+
+        return "unknown";
     }
-}
\ No newline at end of file
+}
@@ -1,11 +1,10 @@
 #pragma once
 
-#include <iostream>
 #include <string>
-#include <unordered_map>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
 
+#include "json-reader.h"
+#include "json-writer.h"
+#include "logger.h"
 #include "user-type.h"
 #include "server-exceptions.h"
 
@@ -17,48 +16,56 @@ namespace Utils
         std::string password;
         UserType type;
 
-        std::string serialize() const
+        static constexpr size_t serializedSizeHint = 64;
+
+        /**
+         * @brief The password is intentionally never serialized.
+         */
+        void serialize(JsonWriter& writer) const
         {
-            try
-            {
-                boost::property_tree::ptree ptree;
-                std::ostringstream buf;
+            writer.beginObject();
+            writer.field("username", username);
+            writer.field("type", getUserTypeString(type));
+            writer.endObject();
+        }
 
-                ptree.put("username", username);
-                ptree.put("type", getUserTypeString(type));
+        std::string serialize() const
+        {
+            std::string out;
+            out.reserve(serializedSizeHint);
 
-                boost::property_tree::write_json(buf, ptree, false);
+            JsonWriter writer(out);
+            serialize(writer);
 
-                return buf.str();
-            }
-            catch(const std::exception& e)
-            {
-                const std::string errorMessage = "An error occured while serializing a user: " + std::string(e.what());
-                std::cerr << errorMessage << '\n';
-                throw HttpBadRequest(errorMessage);
-            }
+            return out;
         }
     };
 
-    static User parseUser(const std::string& serializedUser)
+    /**
+     * Extracts a user from an already parsed (and usually already validated) request body.
+     */
+    static User parseUser(const boost::json::value& document)
     {
         try
         {
-            std::istringstream is(serializedUser);
-            boost::property_tree::ptree ptree;
-            boost::property_tree::read_json(is, ptree);
+            if(!document.is_object())
+            {
+                throw HttpBadRequest("Expected a JSON object.");
+            }
+
+            const auto& obj = document.get_object();
             User user;
 
-            user.username = ptree.get<std::string>("username");
-            user.password = ptree.get<std::string>("password");
-            user.type = static_cast<UserType>(ptree.get<int>("type"));
+            user.username = getJsonString(obj, "username");
+            user.password = getJsonString(obj, "password");
+            user.type = static_cast<UserType>(getJsonInt(obj, "type"));
 
             return user;
         }
         catch(const std::exception& e)
         {
             const std::string errorMessage = "An error occured while deserializing a user: " + std::string(e.what());
-            std::cerr << errorMessage << '\n';
+            LOG_WARNING(errorMessage);
             throw HttpBadRequest(errorMessage);
         }
     }
@@ -0,0 +1,264 @@
+#include "affinity.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+
+#include "logger.h"
+
+namespace Utils
+{
+    namespace
+    {
+        unsigned int parseCpu(std::string_view value, std::string_view list)
+        {
+            unsigned int cpu = 0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), cpu);
+            if(value.empty() || error != std::errc() || end != value.data() + value.size() || cpu >= CPU_SETSIZE)
+            {
+                throw std::invalid_argument("Invalid CPU list: " + std::string(list));
+            }
+            return cpu;
+        }
+
+        std::vector<unsigned int> allowedCpus()
+        {
+            std::vector<unsigned int> cpus;
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if(sched_getaffinity(0, sizeof(set), &set) == 0)
+            {
+                for(unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                {
+                    if(CPU_ISSET(cpu, &set))
+                    {
+                        cpus.push_back(cpu);
+                    }
+                }
+            }
+
+            return cpus;
+        }
+
+        std::string nodesOf(const std::vector<unsigned int>& cpus, const std::vector<NumaNode>& topology)
+        {
+            std::vector<unsigned int> nodes;
+            for(const NumaNode& node : topology)
+            {
+                if(std::any_of(cpus.begin(), cpus.end(), [&node](unsigned int cpu)
+                   {
+                       return std::binary_search(node.cpus.begin(), node.cpus.end(), cpu);
+                   }))
+                {
+                    nodes.push_back(node.id);
+                }
+            }
+            return formatCpuList(nodes);
+        }
+    }
+
+    std::vector<unsigned int> parseCpuList(std::string_view list)
+    {
+        std::vector<unsigned int> cpus;
+
+        while(!list.empty() && (list.back() == '\n' || list.back() == ' '))
+        {
+            list.remove_suffix(1);
+        }
+
+        const std::string_view whole = list;
+        while(!list.empty())
+        {
+            const size_t comma = list.find(',');
+            const std::string_view range = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+            const size_t dash = range.find('-');
+            const unsigned int first = parseCpu(range.substr(0, dash), whole);
+            const unsigned int last = dash == std::string_view::npos ? first : parseCpu(range.substr(dash + 1), whole);
+            if(last < first)
+            {
+                throw std::invalid_argument("Invalid CPU list: " + std::string(whole));
+            }
+
+            for(unsigned int cpu = first; cpu <= last; ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+    std::string formatCpuList(const std::vector<unsigned int>& cpus)
+    {
+        std::string out;
+        for(size_t i = 0; i < cpus.size();)
+        {
+            size_t j = i;
+            while(j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+            {
+                ++j;
+            }
+
+            if(!out.empty())
+            {
+                out += ',';
+            }
+            out += std::to_string(cpus[i]);
+            if(j > i)
+            {
+                out += '-';
+                out += std::to_string(cpus[j]);
+            }
+
+            i = j + 1;
+        }
+        return out;
+    }
+
+    std::vector<NumaNode> readNumaTopology()
+    {
+        std::vector<NumaNode> nodes;
+
+        std::error_code ec;
+        for(const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec))
+        {
+            const std::string name = entry.path().filename().string();
+            unsigned int id = 0;
+            if(name.rfind("node", 0) != 0 ||
+               std::from_chars(name.data() + 4, name.data() + name.size(), id).ec != std::errc())
+            {
+                continue;
+            }
+
+            std::ifstream file(entry.path() / "cpulist");
+            std::string cpulist;
+            std::getline(file, cpulist);
+
+            try
+            {
+                nodes.push_back(NumaNode { id, parseCpuList(cpulist) });
+            }
+            catch(const std::invalid_argument&)
+            {
+                LOG_WARNING("Ignoring NUMA node ", id, " with an unreadable cpulist: ", cpulist);
+            }
+        }
+
+        if(nodes.empty())
+        {
+            nodes.push_back(NumaNode { 0, allowedCpus() });
+        }
+
+        std::sort(nodes.begin(), nodes.end(), [](const NumaNode& lhs, const NumaNode& rhs) { return lhs.id < rhs.id; });
+        return nodes;
+    }
+
+    Affinity& Affinity::instance()
+    {
+        static Affinity affinity;
+        return affinity;
+    }
+
+    void Affinity::configure(std::vector<unsigned int> ioCpus, std::vector<unsigned int> workerCpus, bool numaLocal)
+    {
+        const std::vector<unsigned int> allowed = allowedCpus();
+        for(const auto* cpus : { &ioCpus, &workerCpus })
+        {
+            for(const unsigned int cpu : *cpus)
+            {
+                if(!std::binary_search(allowed.begin(), allowed.end(), cpu))
+                {
+                    throw std::invalid_argument("CPU " + std::to_string(cpu) + " is not available to this process, "
+                                                "which may run on " + formatCpuList(allowed) + ".");
+                }
+            }
+        }
+
+        _allowedCpus = allowed;
+        _ioCpus = std::move(ioCpus);
+        _workerCpus = std::move(workerCpus);
+        _numaLocal = numaLocal;
+    }
+
+    void Affinity::pinIoThread(size_t index) const
+    {
+        // Unpinned I/O threads get back every CPU of the process, since the thread starting
+        // them may already be confined to worker_cpus.
+        if(_ioCpus.empty())
+        {
+            place(_allowedCpus);
+            return;
+        }
+
+        place({ _ioCpus[index % _ioCpus.size()] });
+    }
+
+    void Affinity::pinWorkerThread() const
+    {
+        place(_workerCpus);
+    }
+
+    void Affinity::place(const std::vector<unsigned int>& cpus) const
+    {
+        if(!cpus.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for(const unsigned int cpu : cpus)
+            {
+                CPU_SET(cpu, &set);
+            }
+
+            if(const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); error != 0)
+            {
+                LOG_WARNING("Failed to pin a thread to CPUs ", formatCpuList(cpus), ", error ", error);
+            }
+        }
+
+        // Overrides an inherited policy such as numactl --interleave. Pages are placed on the
+        // node of the CPU which first touches them, i.e. this thread's own node once pinned.
+        if(_numaLocal && syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) != 0)
+        {
+            LOG_WARNING("Failed to set the local NUMA memory policy, errno ", errno);
+        }
+    }
+
+    std::string Affinity::report() const
+    {
+        const std::vector<NumaNode> topology = readNumaTopology();
+
+        size_t cpuCount = 0;
+        for(const NumaNode& node : topology)
+        {
+            cpuCount += node.cpus.size();
+        }
+
+        std::string out = "CPU topology: " + std::to_string(topology.size()) + " NUMA node(s), " + std::to_string(cpuCount) + " CPU(s)";
+        for(const NumaNode& node : topology)
+        {
+            out += "\n  node " + std::to_string(node.id) + ": CPUs " + formatCpuList(node.cpus);
+        }
+
+        out += "\n  I/O threads: ";
+        out += _ioCpus.empty() ? "unpinned" : "one each on CPUs " + formatCpuList(_ioCpus) + " (node " + nodesOf(_ioCpus, topology) + ")";
+        out += "\n  Other threads: ";
+        out += _workerCpus.empty() ? "unpinned" : "CPUs " + formatCpuList(_workerCpus) + " (node " + nodesOf(_workerCpus, topology) + ")";
+        out += "\n  NUMA local allocation: ";
+        out += _numaLocal ? "on" : "off";
+
+        return out;
+    }
+}
@@ -0,0 +1,215 @@
+#include "compression.h"
+
+#include <functional>
+#include <stdexcept>
+#include <strings.h>
+
+#include <zlib.h>
+
+#include "logger.h"
+#include "tracing.h"
+
+namespace Utils
+{
+    namespace
+    {
+        std::string_view trim(std::string_view str)
+        {
+            while(!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+            {
+                str.remove_prefix(1);
+            }
+            while(!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+            {
+                str.remove_suffix(1);
+            }
+            return str;
+        }
+
+        bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs)
+        {
+            return lhs.size() == rhs.size() && strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+        }
+
+        /**
+         * @brief Parses the parameters of one Accept-Encoding entry and returns its q-value in
+         * thousandths, 1000 if absent.
+         */
+        int parseQuality(std::string_view params)
+        {
+            while(!params.empty())
+            {
+                const size_t semicolon = params.find(';');
+                const std::string_view param = trim(params.substr(0, semicolon));
+                params = semicolon == std::string_view::npos ? std::string_view() : params.substr(semicolon + 1);
+
+                if(param.size() < 2 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=')
+                {
+                    continue;
+                }
+
+                const std::string_view value = param.substr(2);
+                if(value.empty() || value[0] != '0')
+                {
+                    return 1000; // "1", "1.0" or malformed
+                }
+
+                int quality = 0;
+                int scale = 100;
+                for(size_t i = 2; i < value.size() && scale > 0; ++i, scale /= 10)
+                {
+                    if(value[i] < '0' || value[i] > '9')
+                    {
+                        break;
+                    }
+                    quality += (value[i] - '0') * scale;
+                }
+                return quality;
+            }
+
+            return 1000;
+        }
+    }
+
+    ContentEncoding negotiateEncoding(std::string_view acceptEncoding)
+    {
+        int gzipQuality = -1;
+        int deflateQuality = -1;
+        int wildcardQuality = -1;
+
+        while(!acceptEncoding.empty())
+        {
+            const size_t comma = acceptEncoding.find(',');
+            const std::string_view entry = acceptEncoding.substr(0, comma);
+            acceptEncoding = comma == std::string_view::npos ? std::string_view() : acceptEncoding.substr(comma + 1);
+
+            const size_t semicolon = entry.find(';');
+            const std::string_view coding = trim(entry.substr(0, semicolon));
+            const int quality = semicolon == std::string_view::npos ? 1000 : parseQuality(entry.substr(semicolon + 1));
+
+            if(equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip"))
+            {
+                gzipQuality = quality;
+            }
+            else if(equalsIgnoreCase(coding, "deflate"))
+            {
+                deflateQuality = quality;
+            }
+            else if(coding == "*")
+            {
+                wildcardQuality = quality;
+            }
+        }
+
+        if(gzipQuality < 0)
+        {
+            gzipQuality = wildcardQuality;
+        }
+        if(deflateQuality < 0)
+        {
+            deflateQuality = wildcardQuality;
+        }
+
+        if(gzipQuality > 0 && gzipQuality >= deflateQuality)
+        {
+            return ContentEncoding::Gzip;
+        }
+        if(deflateQuality > 0)
+        {
+            return ContentEncoding::Deflate;
+        }
+        return ContentEncoding::Identity;
+    }
+
+    std::string compress(std::string_view body, ContentEncoding encoding, int level)
+    {
+        TRACE_SPAN("compress");
+
+        if(encoding == ContentEncoding::Identity)
+        {
+            return std::string(body);
+        }
+
+        // 15 window bits produce a zlib stream, which is what HTTP calls deflate; adding 16
+        // wraps it in a gzip header and trailer instead.
+        const int windowBits = encoding == ContentEncoding::Gzip ? 15 + 16 : 15;
+
+        z_stream stream {};
+        if(deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            throw std::runtime_error("Failed to initialize zlib.");
+        }
+
+        std::string compressed(deflateBound(&stream, body.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+        stream.avail_in = static_cast<uInt>(body.size());
+        stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+        stream.avail_out = static_cast<uInt>(compressed.size());
+
+        const int result = deflate(&stream, Z_FINISH);
+        const size_t compressedSize = stream.total_out;
+        deflateEnd(&stream);
+
+        if(result != Z_STREAM_END)
+        {
+            throw std::runtime_error("Failed to compress a response body.");
+        }
+
+        compressed.resize(compressedSize);
+        return compressed;
+    }
+
+    Compressor& Compressor::instance()
+    {
+        static Compressor compressor;
+        return compressor;
+    }
+
+    void Compressor::configure(int level, size_t minSize, size_t cacheEntries)
+    {
+        _level = level < 0 ? 0 : (level > 9 ? 9 : level);
+        _minSize = minSize;
+
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        _cache.clear();
+        _cache.resize(cacheEntries);
+        _nextEntry = 0;
+
+        LOG_INFO("Response compression level=", _level, ", min_size=", _minSize, ", cache_entries=", cacheEntries);
+    }
+
+    std::shared_ptr<const std::string> Compressor::compress(std::string_view body, ContentEncoding encoding)
+    {
+        if(_cache.empty())
+        {
+            return std::make_shared<const std::string>(Utils::compress(body, encoding, _level));
+        }
+
+        const size_t hash = std::hash<std::string_view>()(body);
+        {
+            std::lock_guard<std::mutex> lock(_cacheMutex);
+            for(const auto& entry : _cache)
+            {
+                if(entry.compressed && entry.hash == hash && entry.encoding == encoding && entry.body == body)
+                {
+                    return entry.compressed;
+                }
+            }
+        }
+
+        // Compress outside the lock; two threads missing on the same body at once just both
+        // do the work.
+        auto compressed = std::make_shared<const std::string>(Utils::compress(body, encoding, _level));
+
+        std::lock_guard<std::mutex> lock(_cacheMutex);
+        Entry& entry = _cache[_nextEntry];
+        _nextEntry = (_nextEntry + 1) % _cache.size();
+
+        entry.hash = hash;
+        entry.encoding = encoding;
+        entry.body.assign(body);
+        entry.compressed = compressed;
+
+        return compressed;
+    }
+}
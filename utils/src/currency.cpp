@@ -0,0 +1,173 @@
+#include "currency.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UTILS_CURRENCY_AVX 1
+#endif
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr double centsPerUnit = 100.0;
+
+#ifdef UTILS_CURRENCY_AVX
+        __attribute__((target("avx")))
+        void scalePricesAvx(double* prices, const double* factors, size_t count)
+        {
+            const __m256d cents = _mm256_set1_pd(centsPerUnit);
+
+            size_t i = 0;
+            for(; i + 4 <= count; i += 4)
+            {
+                // The same operations in the same order as the scalar loop, so the results match.
+                __m256d value = _mm256_mul_pd(_mm256_loadu_pd(prices + i), _mm256_loadu_pd(factors + i));
+                value = _mm256_round_pd(_mm256_mul_pd(value, cents), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                _mm256_storeu_pd(prices + i, _mm256_div_pd(value, cents));
+            }
+
+            scalePricesScalar(prices + i, factors + i, count - i);
+        }
+#endif
+
+        using ScaleKernel = void (*)(double*, const double*, size_t);
+
+        ScaleKernel selectKernel()
+        {
+#ifdef UTILS_CURRENCY_AVX
+            if(__builtin_cpu_supports("avx"))
+            {
+                return scalePricesAvx;
+            }
+#endif
+            return scalePricesScalar;
+        }
+
+        std::string_view trim(std::string_view value)
+        {
+            while(!value.empty() && value.front() == ' ')
+            {
+                value.remove_prefix(1);
+            }
+            while(!value.empty() && value.back() == ' ')
+            {
+                value.remove_suffix(1);
+            }
+            return value;
+        }
+    }
+
+    void scalePricesScalar(double* prices, const double* factors, size_t count)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            // nearbyint rounds ties to even in the default rounding mode, like the AVX path.
+            prices[i] = std::nearbyint(prices[i] * factors[i] * centsPerUnit) / centsPerUnit;
+        }
+    }
+
+    void scalePrices(double* prices, const double* factors, size_t count)
+    {
+        static const ScaleKernel kernel = selectKernel();
+        kernel(prices, factors, count);
+    }
+
+    ExchangeRates& ExchangeRates::instance()
+    {
+        static ExchangeRates rates;
+        return rates;
+    }
+
+    void ExchangeRates::configure(std::string_view rates)
+    {
+        std::vector<std::pair<std::string, double>> parsed;
+
+        while(!rates.empty())
+        {
+            const size_t comma = rates.find(',');
+            const std::string_view entry = trim(rates.substr(0, comma));
+            rates = comma == std::string_view::npos ? std::string_view() : rates.substr(comma + 1);
+            if(entry.empty())
+            {
+                continue;
+            }
+
+            const size_t colon = entry.find(':');
+            const std::string_view code = trim(entry.substr(0, colon));
+            const std::string_view value = colon == std::string_view::npos ? std::string_view() : trim(entry.substr(colon + 1));
+
+            double rate = 0.0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), rate);
+            if(code.empty() || value.empty() || error != std::errc() || end != value.data() + value.size() || !(rate > 0.0) || !std::isfinite(rate))
+            {
+                throw std::invalid_argument("Invalid exchange rate: " + std::string(entry));
+            }
+
+            parsed.emplace_back(code, rate);
+        }
+
+        _rates = std::move(parsed);
+    }
+
+    bool ExchangeRates::knows(std::string_view currency) const
+    {
+        return rateOf(currency) > 0.0;
+    }
+
+    double ExchangeRates::rateOf(std::string_view currency) const
+    {
+        for(const auto& [code, rate] : _rates)
+        {
+            if(code == currency)
+            {
+                return rate;
+            }
+        }
+        return 0.0;
+    }
+
+    void ExchangeRates::convert(std::vector<Flight>& flights, std::string_view target) const
+    {
+        const double targetRate = rateOf(target);
+        if(targetRate == 0.0)
+        {
+            throw std::invalid_argument("No exchange rate for " + std::string(target) + ".");
+        }
+
+        // Gathered into contiguous arrays for the kernel. A result set rarely mixes more than
+        // a couple of currencies, so remembering the last factor skips most rate lookups.
+        std::vector<double> prices(flights.size());
+        std::vector<double> factors(flights.size());
+
+        std::string_view lastCurrency;
+        double lastFactor = 0.0;
+        for(size_t i = 0; i < flights.size(); ++i)
+        {
+            if(lastFactor == 0.0 || flights[i].currency != lastCurrency)
+            {
+                const double sourceRate = rateOf(flights[i].currency);
+                if(sourceRate == 0.0)
+                {
+                    throw std::invalid_argument("No exchange rate for " + flights[i].currency + ".");
+                }
+                lastCurrency = flights[i].currency;
+                lastFactor = targetRate / sourceRate;
+            }
+
+            prices[i] = static_cast<double>(flights[i].price);
+            factors[i] = lastFactor;
+        }
+
+        scalePrices(prices.data(), factors.data(), prices.size());
+
+        for(size_t i = 0; i < flights.size(); ++i)
+        {
+            flights[i].price = prices[i];
+            flights[i].currency = target;
+        }
+    }
+}
@@ -0,0 +1,385 @@
+#include "flight-wire.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr char magic[4] = { 'F', 'L', 'T', 'B' };
+        constexpr size_t headerSize = 24;
+        constexpr size_t recordSize = 36;
+
+        template<typename T>
+        void append(std::string& out, T value)
+        {
+            for(size_t i = 0; i < sizeof(T); ++i)
+            {
+                out += static_cast<char>(static_cast<unsigned char>(static_cast<uint64_t>(value) >> (8 * i)));
+            }
+        }
+
+        template<typename T>
+        void overwrite(std::string& out, size_t at, T value)
+        {
+            for(size_t i = 0; i < sizeof(T); ++i)
+            {
+                out[at + i] = static_cast<char>(static_cast<unsigned char>(static_cast<uint64_t>(value) >> (8 * i)));
+            }
+        }
+
+        template<typename T>
+        T read(const char* at)
+        {
+            T value = 0;
+            for(size_t i = 0; i < sizeof(T); ++i)
+            {
+                value |= static_cast<T>(static_cast<T>(static_cast<unsigned char>(at[i])) << (8 * i));
+            }
+            return value;
+        }
+
+        /**
+         * Result sets hold a handful of distinct codes, so a linear scan beats hashing.
+         */
+        class StringTable
+        {
+        public:
+            uint16_t intern(std::string_view value)
+            {
+                for(size_t i = 0; i < _strings.size(); ++i)
+                {
+                    if(_strings[i] == value)
+                    {
+                        return static_cast<uint16_t>(i);
+                    }
+                }
+
+                if(_strings.size() > UINT16_MAX)
+                {
+                    throw std::invalid_argument("Too many distinct codes for the binary flight format.");
+                }
+
+                _strings.push_back(value);
+                _bytes += value.size();
+                return static_cast<uint16_t>(_strings.size() - 1);
+            }
+
+            const std::vector<std::string_view>& strings() const
+            {
+                return _strings;
+            }
+
+            size_t bytes() const
+            {
+                return _bytes;
+            }
+
+        private:
+            std::vector<std::string_view> _strings;
+            size_t _bytes = 0;
+        };
+
+        struct Record
+        {
+            int64_t departureTime;
+            int64_t arrivalTime;
+            int64_t price;
+            uint16_t origin;
+            uint16_t destination;
+            uint16_t fareCarrier;
+            uint16_t currency;
+            uint8_t type;
+            uint8_t cabin;
+        };
+
+        unsigned int parseField(std::string_view dateTime, size_t at, size_t length)
+        {
+            unsigned int value = 0;
+            const char* begin = dateTime.data() + at;
+            const auto [end, error] = std::from_chars(begin, begin + length, value);
+            if(error != std::errc() || end != begin + length)
+            {
+                throw std::invalid_argument("Invalid date and time: " + std::string(dateTime));
+            }
+            return value;
+        }
+
+        /**
+         * Days since 1970-01-01 in the proleptic Gregorian calendar, from Howard Hinnant's
+         * days_from_civil, so that no time zone or locale is involved.
+         */
+        int64_t daysFromCivil(int64_t year, unsigned int month, unsigned int day)
+        {
+            year -= month <= 2;
+            const int64_t era = (year >= 0 ? year : year - 399) / 400;
+            const unsigned int yearOfEra = static_cast<unsigned int>(year - era * 400);
+            const unsigned int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+            const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+            return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+        }
+
+        /**
+         * The inverse of daysFromCivil, from Howard Hinnant's civil_from_days.
+         */
+        void civilFromDays(int64_t days, int64_t& year, unsigned int& month, unsigned int& day)
+        {
+            days += 719468;
+            const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+            const unsigned int dayOfEra = static_cast<unsigned int>(days - era * 146097);
+            const unsigned int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+            const unsigned int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+            const unsigned int monthIndex = (5 * dayOfYear + 2) / 153;
+            day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+            month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+            year = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+        }
+
+        /**
+         * @brief The q-value of a media range, 1 when absent.
+         */
+        double qualityOf(std::string_view parameters)
+        {
+            const size_t q = parameters.find("q=");
+            if(q == std::string_view::npos)
+            {
+                return 1.0;
+            }
+
+            double quality = 0.0;
+            const std::string_view value = parameters.substr(q + 2);
+            std::from_chars(value.data(), value.data() + value.size(), quality);
+            return quality;
+        }
+    }
+
+    FlightFormat negotiateFlightFormat(std::string_view accept)
+    {
+        double binary = 0.0;
+        double json = 0.0;
+
+        while(!accept.empty())
+        {
+            const size_t comma = accept.find(',');
+            std::string_view range = accept.substr(0, comma);
+            accept = comma == std::string_view::npos ? std::string_view() : accept.substr(comma + 1);
+
+            const size_t semicolon = range.find(';');
+            const std::string_view parameters = semicolon == std::string_view::npos ? std::string_view() : range.substr(semicolon + 1);
+            std::string_view mediaType = range.substr(0, semicolon);
+            while(!mediaType.empty() && mediaType.front() == ' ')
+            {
+                mediaType.remove_prefix(1);
+            }
+            while(!mediaType.empty() && mediaType.back() == ' ')
+            {
+                mediaType.remove_suffix(1);
+            }
+
+            if(mediaType == flightWireMediaType)
+            {
+                binary = qualityOf(parameters);
+            }
+            else if(mediaType == "application/json" || mediaType == "application/*" || mediaType == "*/*")
+            {
+                json = std::max(json, qualityOf(parameters));
+            }
+        }
+
+        return binary > 0.0 && binary >= json ? FlightFormat::Binary : FlightFormat::Json;
+    }
+
+    int64_t parseDateTime(std::string_view dateTime)
+    {
+        // YYYY-MM-DD HH:MM:SS, with a 'T' accepted in place of the space.
+        if(dateTime.size() < 19 || dateTime[4] != '-' || dateTime[7] != '-' ||
+           (dateTime[10] != ' ' && dateTime[10] != 'T') || dateTime[13] != ':' || dateTime[16] != ':')
+        {
+            throw std::invalid_argument("Invalid date and time: " + std::string(dateTime));
+        }
+
+        const unsigned int year = parseField(dateTime, 0, 4);
+        const unsigned int month = parseField(dateTime, 5, 2);
+        const unsigned int day = parseField(dateTime, 8, 2);
+        const unsigned int hour = parseField(dateTime, 11, 2);
+        const unsigned int minute = parseField(dateTime, 14, 2);
+        const unsigned int second = parseField(dateTime, 17, 2);
+
+        if(month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        {
+            throw std::invalid_argument("Invalid date and time: " + std::string(dateTime));
+        }
+
+        return daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    }
+
+    std::string formatDateTime(int64_t seconds)
+    {
+        int64_t days = seconds / 86400;
+        int64_t time = seconds % 86400;
+        if(time < 0)
+        {
+            time += 86400;
+            --days;
+        }
+
+        int64_t year;
+        unsigned int month;
+        unsigned int day;
+        civilFromDays(days, year, month, day);
+
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%04lld-%02u-%02u %02lld:%02lld:%02lld", static_cast<long long>(year), month, day,
+                      static_cast<long long>(time / 3600), static_cast<long long>(time / 60 % 60), static_cast<long long>(time % 60));
+        return buf;
+    }
+
+    int64_t parseDate(std::string_view date)
+    {
+        if(date.size() != 10)
+        {
+            throw std::invalid_argument("Invalid date: " + std::string(date));
+        }
+
+        std::string dateTime(date);
+        dateTime += " 00:00:00";
+        return parseDateTime(dateTime) / 86400;
+    }
+
+    std::string formatDate(int64_t day)
+    {
+        std::string date = formatDateTime(day * 86400);
+        date.resize(10);
+        return date;
+    }
+
+    std::string encodeFlights(const std::vector<Flight>& flights)
+    {
+        StringTable strings;
+        std::vector<Record> records;
+        records.reserve(flights.size());
+
+        for(const Flight& flight : flights)
+        {
+            records.push_back(Record {
+                .departureTime = parseDateTime(flight.departureTime),
+                .arrivalTime = parseDateTime(flight.arrivalTime),
+                .price = std::llround(flight.price * flightPriceScale),
+                .origin = strings.intern(flight.origin),
+                .destination = strings.intern(flight.destination),
+                .fareCarrier = strings.intern(flight.fareCarrier),
+                .currency = strings.intern(flight.currency),
+                .type = static_cast<uint8_t>(flight.type),
+                .cabin = static_cast<uint8_t>(flight.cabin)
+            });
+        }
+
+        const size_t totalSize = headerSize + 4 * (strings.strings().size() + 1) + strings.bytes() + recordSize * records.size();
+        if(totalSize > UINT32_MAX)
+        {
+            throw std::invalid_argument("Too many flights for the binary flight format.");
+        }
+
+        std::string out;
+        out.reserve(totalSize);
+
+        out.append(magic, sizeof(magic));
+        append<uint16_t>(out, flightWireVersion);
+        append<uint16_t>(out, recordSize);
+        append<uint32_t>(out, totalSize);
+        append<uint32_t>(out, records.size());
+        append<uint32_t>(out, strings.strings().size());
+        append<uint32_t>(out, strings.bytes());
+
+        uint32_t offset = 0;
+        for(const std::string_view string : strings.strings())
+        {
+            append<uint32_t>(out, offset);
+            offset += static_cast<uint32_t>(string.size());
+        }
+        append<uint32_t>(out, offset);
+
+        for(const std::string_view string : strings.strings())
+        {
+            out.append(string);
+        }
+
+        for(const Record& record : records)
+        {
+            append<uint64_t>(out, record.departureTime);
+            append<uint64_t>(out, record.arrivalTime);
+            append<uint64_t>(out, record.price);
+            append<uint16_t>(out, record.origin);
+            append<uint16_t>(out, record.destination);
+            append<uint16_t>(out, record.fareCarrier);
+            append<uint16_t>(out, record.currency);
+            append<uint8_t>(out, record.type);
+            append<uint8_t>(out, record.cabin);
+            append<uint16_t>(out, 0);
+        }
+
+        return out;
+    }
+
+    FlightBatchView::FlightBatchView(std::string_view data)
+    {
+        const auto invalid = [](const char* reason)
+        {
+            return std::invalid_argument(std::string("Malformed binary flight batch: ") + reason);
+        };
+
+        if(data.size() < headerSize || std::string_view(data.data(), sizeof(magic)) != std::string_view(magic, sizeof(magic)))
+        {
+            throw invalid("bad magic");
+        }
+
+        const uint16_t version = read<uint16_t>(data.data() + 4);
+        const size_t recordBytes = read<uint16_t>(data.data() + 6);
+        const size_t totalSize = read<uint32_t>(data.data() + 8);
+        const size_t flightCount = read<uint32_t>(data.data() + 12);
+        const size_t stringCount = read<uint32_t>(data.data() + 16);
+        const size_t stringBytes = read<uint32_t>(data.data() + 20);
+
+        if(version < flightWireVersion || recordBytes < recordSize)
+        {
+            throw invalid("unsupported version");
+        }
+        if(totalSize != data.size() ||
+           totalSize != headerSize + 4 * (stringCount + 1) + stringBytes + recordBytes * flightCount)
+        {
+            throw invalid("sizes do not add up");
+        }
+
+        _offsets = data.data() + headerSize;
+        _strings = _offsets + 4 * (stringCount + 1);
+        _records = _strings + stringBytes;
+        _flightCount = flightCount;
+        _recordSize = recordBytes;
+
+        uint32_t previous = 0;
+        for(size_t i = 0; i <= stringCount; ++i)
+        {
+            const uint32_t offset = read<uint32_t>(_offsets + 4 * i);
+            if(offset < previous || offset > stringBytes || (i == 0 && offset != 0) || (i == stringCount && offset != stringBytes))
+            {
+                throw invalid("bad string offsets");
+            }
+            previous = offset;
+        }
+
+        for(size_t i = 0; i < flightCount; ++i)
+        {
+            const char* record = _records + i * _recordSize;
+            for(size_t field = 24; field < 32; field += 2)
+            {
+                if(read<uint16_t>(record + field) >= stringCount)
+                {
+                    throw invalid("string index out of range");
+                }
+            }
+        }
+    }
+}
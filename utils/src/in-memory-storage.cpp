@@ -0,0 +1,261 @@
+#include "in-memory-storage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "logger.h"
+#include "server-exceptions.h"
+
+namespace Utils
+{
+    InMemoryStorage::InMemoryStorage()
+    {
+        const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+        const auto epoch = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count());
+        for(auto& version : _versions)
+        {
+            version.store(epoch, std::memory_order_relaxed);
+        }
+
+        // Mirrors the rows inserted by sql/create-tables.sql.
+        insertPairLocked(Pair { .origin = "BLA", .destination = "MUC", .type = false, .fareCarrier = "FF" });
+        insertPairLocked(Pair { .origin = "SOF", .destination = "LON", .type = true, .fareCarrier = "FB" });
+        insertPairLocked(Pair { .origin = "LON", .destination = "FRA", .type = true, .fareCarrier = "BA" });
+
+        insertUserLocked(User { .username = "AirBaltic", .password = "password1", .type = static_cast<UserType>(1) });
+        insertUserLocked(User { .username = "BulgariaAir", .password = "password2", .type = static_cast<UserType>(1) });
+        insertUserLocked(User { .username = "Secretuser205", .password = "password3", .type = static_cast<UserType>(2) });
+        insertUserLocked(User { .username = "SuperAdmin1", .password = "4strong_Password4", .type = static_cast<UserType>(3) });
+    }
+
+    bool InMemoryStorage::isAuthenticated(std::string_view username, std::string_view password)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+
+        const auto it = _userIndex.find(username);
+        return it != _userIndex.end() && _users[it->second].password == password;
+    }
+
+    bool InMemoryStorage::isAuthorized(std::string_view username, UserType userType)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+
+        const auto it = _userIndex.find(username);
+        return it != _userIndex.end() && _users[it->second].type == userType;
+    }
+
+    void InMemoryStorage::insertUser(const User& user)
+    {
+        LOG_DEBUG("Inserting user with username=", user.username, ", type=", user.type, " into memory");
+
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        insertUserLocked(user);
+    }
+
+    void InMemoryStorage::insertUserUnsafe(const User& user)
+    {
+        insertUser(user);
+    }
+
+    void InMemoryStorage::insertPair(const Pair& pair)
+    {
+        LOG_DEBUG("Inserting pair with origin=", pair.origin, ", destination=", pair.destination, " into memory");
+
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        insertPairLocked(pair);
+    }
+
+    std::vector<bool> InMemoryStorage::insertUsers(const std::vector<User>& users)
+    {
+        std::vector<bool> inserted(users.size(), false);
+
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        for(size_t i = 0; i < users.size(); ++i)
+        {
+            if(_userIndex.count(users[i].username) == 0)
+            {
+                insertUserLocked(users[i]);
+                inserted[i] = true;
+            }
+        }
+
+        return inserted;
+    }
+
+    std::vector<bool> InMemoryStorage::insertPairs(const std::vector<Pair>& pairs)
+    {
+        std::vector<bool> inserted(pairs.size(), false);
+
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        for(size_t i = 0; i < pairs.size(); ++i)
+        {
+            if(_pairIndex.count(pairKey(pairs[i].origin, pairs[i].destination)) == 0)
+            {
+                insertPairLocked(pairs[i]);
+                inserted[i] = true;
+            }
+        }
+
+        return inserted;
+    }
+
+    std::vector<User> InMemoryStorage::getUsers()
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        return std::vector<User>(_users.begin(), _users.end());
+    }
+
+    std::vector<Pair> InMemoryStorage::getPairs()
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        return _pairs;
+    }
+
+    template<typename Container>
+    Page<typename Container::value_type> InMemoryStorage::pageOf(const Container& rows, uint64_t afterId, size_t limit)
+    {
+        Page<typename Container::value_type> page;
+        const size_t first = static_cast<size_t>(std::min<uint64_t>(afterId, rows.size()));
+        const size_t last = std::min(rows.size(), first + limit);
+
+        page.records.assign(rows.begin() + first, rows.begin() + last);
+        page.lastId = last > first ? last : afterId;
+        page.hasMore = last < rows.size();
+        return page;
+    }
+
+    Page<User> InMemoryStorage::getUsersPage(uint64_t afterId, size_t limit)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        return pageOf(_users, afterId, limit);
+    }
+
+    Page<Pair> InMemoryStorage::getPairsPage(uint64_t afterId, size_t limit)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        return pageOf(_pairs, afterId, limit);
+    }
+
+    std::optional<Pair> InMemoryStorage::getPair(const std::string& origin, const std::string& destination)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+
+        const auto it = _pairIndex.find(pairKey(origin, destination));
+        if(it == _pairIndex.end())
+        {
+            return std::nullopt;
+        }
+
+        return _pairs[it->second];
+    }
+
+    std::vector<Pair> InMemoryStorage::getPairsUnsafe(const std::string& origin, const std::string& destination)
+    {
+        std::vector<Pair> pairs;
+        if(auto pair = getPair(origin, destination))
+        {
+            pairs.push_back(std::move(*pair));
+        }
+        return pairs;
+    }
+
+    std::vector<Flight> InMemoryStorage::getFlights(const std::string& origin, const std::string& destination)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+
+        if(!origin.empty() && !destination.empty())
+        {
+            const auto it = _pairIndex.find(pairKey(origin, destination));
+            return it == _pairIndex.end() ? std::vector<Flight>() : _flightsByPair[it->second];
+        }
+
+        std::vector<Flight> flights;
+        for(size_t i = 0; i < _pairs.size(); ++i)
+        {
+            if((origin.empty() || _pairs[i].origin == origin) &&
+               (destination.empty() || _pairs[i].destination == destination))
+            {
+                flights.insert(flights.end(), _flightsByPair[i].begin(), _flightsByPair[i].end());
+            }
+        }
+
+        return flights;
+    }
+
+    Page<Flight> InMemoryStorage::getFlightsPage(uint64_t afterId, size_t limit)
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+
+        Page<Flight> page;
+        const size_t first = static_cast<size_t>(std::min<uint64_t>(afterId, _flightOrder.size()));
+        const size_t last = std::min(_flightOrder.size(), first + limit);
+
+        page.records.reserve(last - first);
+        for(size_t i = first; i < last; ++i)
+        {
+            const auto [pair, position] = _flightOrder[i];
+            page.records.push_back(_flightsByPair[pair][position]);
+        }
+        page.lastId = last > first ? last : afterId;
+        page.hasMore = last < _flightOrder.size();
+        return page;
+    }
+
+    void InMemoryStorage::insertMissingFlights(const std::function<Flight(const Pair&)>& makeFlight)
+    {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+
+        size_t inserted = 0;
+        for(size_t i = 0; i < _pairs.size(); ++i)
+        {
+            if(_flightsByPair[i].empty())
+            {
+                _flightsByPair[i].push_back(makeFlight(_pairs[i]));
+                _flightOrder.emplace_back(i, _flightsByPair[i].size() - 1);
+                ++inserted;
+            }
+        }
+
+        if(inserted != 0)
+        {
+            bumpVersion(Table::Flights, inserted);
+        }
+
+        LOG_DEBUG("Inserted flights for ", inserted, " pairs into memory");
+    }
+
+    uint64_t InMemoryStorage::getTableVersion(Table table)
+    {
+        return _versions[static_cast<size_t>(table)].load(std::memory_order_acquire);
+    }
+
+    void InMemoryStorage::insertUserLocked(const User& user)
+    {
+        if(_userIndex.count(user.username) != 0)
+        {
+            throw HttpStateConflict("User already exists.");
+        }
+
+        _users.push_back(user);
+        _userIndex.emplace(_users.back().username, _users.size() - 1);
+        bumpVersion(Table::Users);
+    }
+
+    void InMemoryStorage::insertPairLocked(const Pair& pair)
+    {
+        if(!_pairIndex.emplace(pairKey(pair.origin, pair.destination), _pairs.size()).second)
+        {
+            throw HttpStateConflict("Pair already exists.");
+        }
+
+        _pairs.push_back(pair);
+        _flightsByPair.emplace_back();
+        bumpVersion(Table::Pairs);
+    }
+
+    void InMemoryStorage::bumpVersion(Table table, uint64_t rows)
+    {
+        _versions[static_cast<size_t>(table)].fetch_add(rows, std::memory_order_release);
+    }
+}
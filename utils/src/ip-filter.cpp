@@ -0,0 +1,235 @@
+#include "ip-filter.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+
+#include "logger.h"
+
+namespace Utils
+{
+    namespace
+    {
+        struct Prefix
+        {
+            bool v6;
+            unsigned char address[16];
+            unsigned int length;
+        };
+
+        const unsigned char v4MappedPrefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+
+        bool isV4Mapped(const unsigned char* address)
+        {
+            return std::memcmp(address, v4MappedPrefix, sizeof(v4MappedPrefix)) == 0;
+        }
+
+        Prefix parsePrefix(std::string_view entry)
+        {
+            const auto invalid = [entry]()
+            {
+                return std::invalid_argument("Invalid IP address or CIDR range: " + std::string(entry));
+            };
+
+            const size_t slash = entry.find('/');
+            const std::string address(entry.substr(0, slash));
+
+            Prefix prefix{};
+            prefix.v6 = address.find(':') != std::string::npos;
+            if(inet_pton(prefix.v6 ? AF_INET6 : AF_INET, address.c_str(), prefix.address) != 1)
+            {
+                throw invalid();
+            }
+
+            const unsigned int maxLength = prefix.v6 ? 128 : 32;
+            prefix.length = maxLength;
+            if(slash != std::string_view::npos)
+            {
+                const std::string_view length = entry.substr(slash + 1);
+                const auto [end, error] = std::from_chars(length.data(), length.data() + length.size(), prefix.length);
+                if(length.empty() || error != std::errc() || end != length.data() + length.size() || prefix.length > maxLength)
+                {
+                    throw invalid();
+                }
+            }
+
+            // Keep only the network bits, so that 10.1.2.3/8 and 10.0.0.0/8 are the same entry.
+            for(unsigned int bit = prefix.length; bit < maxLength; ++bit)
+            {
+                prefix.address[bit / 8] &= static_cast<unsigned char>(~(0x80u >> (bit % 8)));
+            }
+
+            // A mapped IPv4 range is stored with the IPv4 ones, where the lookups for it go.
+            if(prefix.v6 && prefix.length >= 96 && isV4Mapped(prefix.address))
+            {
+                std::memmove(prefix.address, prefix.address + 12, 4);
+                prefix.v6 = false;
+                prefix.length -= 96;
+            }
+
+            return prefix;
+        }
+
+        std::string formatPrefix(const Prefix& prefix)
+        {
+            char buffer[INET6_ADDRSTRLEN];
+            inet_ntop(prefix.v6 ? AF_INET6 : AF_INET, prefix.address, buffer, sizeof(buffer));
+            return std::string(buffer) + '/' + std::to_string(prefix.length);
+        }
+    }
+
+    CidrTrie::CidrTrie(const std::vector<std::string>& entries)
+    {
+        std::vector<Prefix> prefixes;
+        prefixes.reserve(entries.size());
+        for(const std::string& entry : entries)
+        {
+            prefixes.push_back(parsePrefix(entry));
+        }
+
+        // Shorter prefixes first, so that a range covered by one already inserted is skipped
+        // instead of leaving unreachable nodes behind.
+        std::stable_sort(prefixes.begin(), prefixes.end(), [](const Prefix& a, const Prefix& b)
+        {
+            return a.length < b.length;
+        });
+
+        for(const Prefix& prefix : prefixes)
+        {
+            insert(prefix.v6 ? _v6 : _v4, prefix.address, prefix.length);
+            _entries.push_back(formatPrefix(prefix));
+        }
+
+        std::sort(_entries.begin(), _entries.end());
+        _entries.erase(std::unique(_entries.begin(), _entries.end()), _entries.end());
+    }
+
+    void CidrTrie::insert(Family& family, const unsigned char* address, unsigned int prefixLength)
+    {
+        if(family.all)
+        {
+            return;
+        }
+
+        if(prefixLength == 0)
+        {
+            family.all = true;
+            family.nodes.assign(1, Node());
+            return;
+        }
+
+        uint32_t node = 0;
+        for(unsigned int bit = 0; bit < prefixLength; ++bit)
+        {
+            const unsigned int side = (address[bit / 8] >> (7 - bit % 8)) & 1;
+            const uint32_t child = family.nodes[node].children[side];
+
+            if(child == blocked)
+            {
+                return;
+            }
+
+            if(bit + 1 == prefixLength)
+            {
+                family.nodes[node].children[side] = blocked;
+                return;
+            }
+
+            if(child == none)
+            {
+                family.nodes.emplace_back();
+                family.nodes[node].children[side] = static_cast<uint32_t>(family.nodes.size() - 1);
+            }
+
+            node = family.nodes[node].children[side];
+        }
+    }
+
+    bool CidrTrie::contains(const Family& family, const unsigned char* address, unsigned int bits)
+    {
+        if(family.all)
+        {
+            return true;
+        }
+
+        uint32_t node = 0;
+        for(unsigned int bit = 0; bit < bits; ++bit)
+        {
+            node = family.nodes[node].children[(address[bit / 8] >> (7 - bit % 8)) & 1];
+            if(node == blocked)
+            {
+                return true;
+            }
+            if(node == none)
+            {
+                return false;
+            }
+        }
+
+        return false;
+    }
+
+    bool CidrTrie::contains(const unsigned char* address, size_t size) const
+    {
+        if(size == 4)
+        {
+            return contains(_v4, address, 32);
+        }
+
+        if(size == 16)
+        {
+            // Mapped ranges of /96 and longer live with the IPv4 ones, but a shorter IPv6 range,
+            // ::/0 included, can still cover the mapped addresses.
+            return (isV4Mapped(address) && contains(_v4, address + 12, 32)) || contains(_v6, address, 128);
+        }
+
+        return false;
+    }
+
+    IpFilter& IpFilter::instance()
+    {
+        static IpFilter filter;
+        return filter;
+    }
+
+    IpFilter::IpFilter()
+        : _trie(std::make_shared<const CidrTrie>()) {}
+
+    void IpFilter::replace(std::shared_ptr<const CidrTrie> trie)
+    {
+        if(!trie)
+        {
+            trie = std::make_shared<const CidrTrie>();
+        }
+
+        const size_t entries = trie->entries().size();
+        std::atomic_store(&_trie, std::move(trie));
+        _generation.fetch_add(1, std::memory_order_release);
+
+        LOG_INFO("IP filter updated, ", entries, " blocked range(s)");
+    }
+
+    std::shared_ptr<const CidrTrie> IpFilter::current() const
+    {
+        return std::atomic_load(&_trie);
+    }
+
+    bool IpFilter::blocks(const unsigned char* address, size_t size) const
+    {
+        // Only touches the shared pointer, and its lock, when the trie has been replaced.
+        thread_local uint64_t seenGeneration = 0;
+        thread_local std::shared_ptr<const CidrTrie> trie;
+
+        const uint64_t generation = _generation.load(std::memory_order_acquire);
+        if(generation != seenGeneration)
+        {
+            trie = current();
+            seenGeneration = generation;
+        }
+
+        return trie->contains(address, size);
+    }
+}
@@ -0,0 +1,259 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+
+namespace Utils
+{
+    namespace
+    {
+        constexpr size_t ringCapacity = 256; // must be a power of two
+        constexpr size_t maxMessageSize = 480;
+        constexpr auto drainInterval = std::chrono::milliseconds(20);
+
+        constexpr std::string_view levelNames[] = { "[DEBUG] ", "[INFO] ", "[WARNING] ", "[ERROR] " };
+
+        void appendTimestamp(std::string& out, std::chrono::system_clock::time_point time)
+        {
+            const auto sinceEpoch = time.time_since_epoch();
+            const std::time_t seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count();
+            const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count() % 1000;
+
+            std::tm utc;
+            gmtime_r(&seconds, &utc);
+
+            char buf[32];
+            const size_t length = std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &utc);
+            out.append(buf, length);
+            std::snprintf(buf, sizeof(buf), ".%03dZ ", static_cast<int>(millis));
+            out.append(buf);
+        }
+    }
+
+    /**
+     * A single-producer, single-consumer ring of fixed-size message slots. The owning thread
+     * is the only producer and the writer thread is the only consumer.
+     */
+    class Logger::Ring
+    {
+    public:
+        struct Slot
+        {
+            std::chrono::system_clock::time_point time;
+            LogLevel level;
+            uint32_t length;
+            bool truncated;
+            char text[maxMessageSize];
+        };
+
+        bool push(LogLevel level, std::string_view message)
+        {
+            const size_t head = _head.load(std::memory_order_relaxed);
+            if(head - _tail.load(std::memory_order_acquire) == ringCapacity)
+            {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            Slot& slot = _slots[head & (ringCapacity - 1)];
+            slot.time = std::chrono::system_clock::now();
+            slot.level = level;
+            slot.length = static_cast<uint32_t>(std::min(message.size(), maxMessageSize));
+            slot.truncated = message.size() > maxMessageSize;
+            std::memcpy(slot.text, message.data(), slot.length);
+
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Appends all committed messages to out. Returns the number of messages consumed.
+         */
+        size_t consume(std::string& out)
+        {
+            const size_t head = _head.load(std::memory_order_acquire);
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            const size_t count = head - tail;
+
+            for(; tail != head; ++tail)
+            {
+                const Slot& slot = _slots[tail & (ringCapacity - 1)];
+                appendTimestamp(out, slot.time);
+                out.append(levelNames[static_cast<int>(slot.level)]);
+                out.append(slot.text, slot.length);
+                if(slot.truncated)
+                {
+                    out.append("... [truncated]");
+                }
+                out += '\n';
+            }
+
+            _tail.store(tail, std::memory_order_release);
+
+            const size_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+            if(dropped != 0)
+            {
+                appendTimestamp(out, std::chrono::system_clock::now());
+                out.append(levelNames[static_cast<int>(LogLevel::Warning)]);
+                out.append(std::to_string(dropped));
+                out.append(" log messages dropped, the logging ring buffer was full\n");
+            }
+
+            return count;
+        }
+
+        bool empty() const
+        {
+            return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+        }
+
+        unsigned int nextDebugSequence()
+        {
+            return _debugSequence++;
+        }
+
+    private:
+        alignas(64) std::atomic<size_t> _head { 0 };
+        alignas(64) std::atomic<size_t> _tail { 0 };
+        alignas(64) std::atomic<size_t> _dropped { 0 };
+        unsigned int _debugSequence = 0; // owning thread only
+        Slot _slots[ringCapacity];
+    };
+
+    LogLevel parseLogLevel(std::string_view level)
+    {
+        if(level == "debug")    return LogLevel::Debug;
+        if(level == "info")     return LogLevel::Info;
+        if(level == "warning")  return LogLevel::Warning;
+        if(level == "error")    return LogLevel::Error;
+        if(level == "off")      return LogLevel::Off;
+
+        throw std::invalid_argument("Unknown log level: " + std::string(level));
+    }
+
+    Logger& Logger::instance()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::~Logger()
+    {
+        stop();
+    }
+
+    void Logger::configure(LogLevel level, unsigned int debugSampleRate)
+    {
+        _level.store(static_cast<int>(level), std::memory_order_relaxed);
+        _debugSampleRate.store(std::max(debugSampleRate, 1u), std::memory_order_relaxed);
+    }
+
+    void Logger::start()
+    {
+        if(_running.exchange(true))
+        {
+            return;
+        }
+
+        _writerThread = std::thread([this]() { run(); });
+    }
+
+    void Logger::stop()
+    {
+        if(!_running.exchange(false))
+        {
+            return;
+        }
+
+        if(_writerThread.joinable())
+        {
+            _writerThread.join();
+        }
+    }
+
+    bool Logger::shouldSampleDebug()
+    {
+        const unsigned int rate = _debugSampleRate.load(std::memory_order_relaxed);
+        return rate == 1 || localRing().nextDebugSequence() % rate == 0;
+    }
+
+    void Logger::write(LogLevel level, std::string_view message)
+    {
+        if(_running.load(std::memory_order_acquire))
+        {
+            localRing().push(level, message);
+            return;
+        }
+
+        std::string line;
+        appendTimestamp(line, std::chrono::system_clock::now());
+        line.append(levelNames[static_cast<int>(level)]);
+        line.append(message);
+        line += '\n';
+
+        std::lock_guard<std::mutex> lock(_syncMutex);
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fflush(stdout);
+    }
+
+    Logger::Ring& Logger::localRing()
+    {
+        thread_local std::shared_ptr<Ring> ring;
+        if(!ring)
+        {
+            ring = std::make_shared<Ring>();
+
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            _rings.push_back(ring);
+        }
+
+        return *ring;
+    }
+
+    void Logger::run()
+    {
+        std::string out;
+        out.reserve(64 * 1024);
+
+        while(_running.load(std::memory_order_acquire))
+        {
+            if(!drain(out))
+            {
+                std::this_thread::sleep_for(drainInterval);
+            }
+        }
+
+        // Pick up whatever was logged while stopping.
+        while(drain(out)) {}
+    }
+
+    bool Logger::drain(std::string& out)
+    {
+        size_t consumed = 0;
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            for(const auto& ring : _rings)
+            {
+                consumed += ring->consume(out);
+            }
+
+            // Rings referenced only by this list belong to threads which have exited.
+            _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<Ring>& ring) {
+                                        return ring.use_count() == 1 && ring->empty(); }),
+                         _rings.end());
+        }
+
+        if(!out.empty())
+        {
+            std::lock_guard<std::mutex> lock(_syncMutex);
+            std::fwrite(out.data(), 1, out.size(), stdout);
+            std::fflush(stdout);
+            out.clear();
+        }
+
+        return consumed != 0;
+    }
+}
@@ -0,0 +1,313 @@
+#include "metrics.h"
+
+#include <charconv>
+
+namespace Utils
+{
+    namespace
+    {
+        // Prometheus bucket boundaries in microseconds. Every boundary is resolved against the
+        // underlying log-linear buckets, so counts are exact to within one sub-bucket.
+        constexpr uint64_t exportedBucketsMicros[] = {
+            100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+            100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+        };
+
+        constexpr double exportedQuantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+        void appendNumber(std::string& out, uint64_t value)
+        {
+            char buf[24];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, result.ptr - buf);
+        }
+
+        void appendNumber(std::string& out, int64_t value)
+        {
+            char buf[24];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, result.ptr - buf);
+        }
+
+        void appendSeconds(std::string& out, uint64_t micros)
+        {
+            char buf[32];
+            const auto result = std::to_chars(buf, buf + sizeof(buf), static_cast<double>(micros) / 1e6);
+            out.append(buf, result.ptr - buf);
+        }
+
+        void appendLabelValue(std::string& out, const std::string& value)
+        {
+            for(const char c : value)
+            {
+                switch(c)
+                {
+                    case '\\':  out.append("\\\\"); break;
+                    case '"':   out.append("\\\""); break;
+                    case '\n':  out.append("\\n"); break;
+                    default:    out += c;
+                }
+            }
+        }
+
+        void appendRouteLabels(std::string& out, const RouteMetrics& route)
+        {
+            out.append("method=\"");
+            appendLabelValue(out, route.method());
+            out.append("\",route=\"");
+            appendLabelValue(out, route.route());
+            out += '"';
+        }
+
+        void appendFamilyHeader(std::string& out, const char* name, const char* type, const std::string& help)
+        {
+            out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+            out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+        }
+    }
+
+    size_t currentMetricsShard()
+    {
+        static std::atomic<size_t> nextShard { 0 };
+        thread_local const size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % metricsShardCount;
+        return shard;
+    }
+
+    uint64_t Counter::value() const
+    {
+        uint64_t total = 0;
+        for(const auto& shard : _shards)
+        {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    Histogram ShardedHistogram::snapshot() const
+    {
+        Histogram histogram;
+        for(size_t s = 0; s < metricsShardCount; ++s)
+        {
+            const Shard& shard = _shards[s];
+            for(size_t i = 0; i < Histogram::bucketCount; ++i)
+            {
+                const uint64_t count = shard.buckets[i].load(std::memory_order_relaxed);
+                if(count != 0)
+                {
+                    histogram.addBucket(i, count);
+                }
+            }
+            histogram.addSum(shard.sum.load(std::memory_order_relaxed));
+        }
+        return histogram;
+    }
+
+    size_t RouteMetrics::statusSlot(int statusCode)
+    {
+        for(size_t i = 0; i < std::size(trackedStatusCodes); ++i)
+        {
+            if(trackedStatusCodes[i] == statusCode)
+            {
+                return i;
+            }
+        }
+        return statusSlotCount - 1;
+    }
+
+    void RouteMetrics::end(int statusCode, std::chrono::nanoseconds latency, size_t bytes)
+    {
+        Shard& shard = _shards[currentMetricsShard()];
+        shard.requests[statusSlot(statusCode)].fetch_add(1, std::memory_order_relaxed);
+        shard.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        shard.inFlight.fetch_sub(1, std::memory_order_relaxed);
+
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        _latency.record(micros > 0 ? static_cast<uint64_t>(micros) : 0);
+    }
+
+    uint64_t RouteMetrics::requests(size_t statusSlot) const
+    {
+        uint64_t total = 0;
+        for(const auto& shard : _shards)
+        {
+            total += shard.requests[statusSlot].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint64_t RouteMetrics::bytes() const
+    {
+        uint64_t total = 0;
+        for(const auto& shard : _shards)
+        {
+            total += shard.bytes.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    int64_t RouteMetrics::inFlight() const
+    {
+        int64_t total = 0;
+        for(const auto& shard : _shards)
+        {
+            total += shard.inFlight.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    Metrics& Metrics::instance()
+    {
+        static Metrics metrics;
+        return metrics;
+    }
+
+    RouteMetrics& Metrics::route(const std::string& method, const std::string& route)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(auto& existing : _routes)
+        {
+            if(existing.method() == method && existing.route() == route)
+            {
+                return existing;
+            }
+        }
+        return _routes.emplace_back(method, route);
+    }
+
+    Counter& Metrics::counter(const std::string& name, const std::string& help)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(auto& existing : _counters)
+        {
+            if(existing.name() == name)
+            {
+                return existing;
+            }
+        }
+        return _counters.emplace_back(name, help);
+    }
+
+    std::string Metrics::renderPrometheus() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::string out;
+        out.reserve(4096 + _routes.size() * 4096);
+
+        std::deque<Histogram> latencies;
+        for(const auto& route : _routes)
+        {
+            latencies.push_back(route.latencyMicros());
+        }
+
+        appendFamilyHeader(out, "http_requests_total", "counter", "Requests handled, by route and status code.");
+        for(const auto& route : _routes)
+        {
+            for(size_t slot = 0; slot < RouteMetrics::statusSlotCount; ++slot)
+            {
+                const uint64_t count = route.requests(slot);
+                if(count == 0)
+                {
+                    continue;
+                }
+
+                out.append("http_requests_total{");
+                appendRouteLabels(out, route);
+                out.append(",code=\"");
+                if(slot < std::size(RouteMetrics::trackedStatusCodes))
+                {
+                    appendNumber(out, static_cast<uint64_t>(RouteMetrics::trackedStatusCodes[slot]));
+                }
+                else
+                {
+                    out.append("other");
+                }
+                out.append("\"} ");
+                appendNumber(out, count);
+                out += '\n';
+            }
+        }
+
+        appendFamilyHeader(out, "http_request_duration_seconds", "histogram", "Time spent in the request handler.");
+        for(size_t r = 0; r < _routes.size(); ++r)
+        {
+            const auto& route = _routes[r];
+            const auto& latency = latencies[r];
+
+            for(const uint64_t bound : exportedBucketsMicros)
+            {
+                out.append("http_request_duration_seconds_bucket{");
+                appendRouteLabels(out, route);
+                out.append(",le=\"");
+                appendSeconds(out, bound);
+                out.append("\"} ");
+                appendNumber(out, latency.countAtOrBelow(bound));
+                out += '\n';
+            }
+
+            out.append("http_request_duration_seconds_bucket{");
+            appendRouteLabels(out, route);
+            out.append(",le=\"+Inf\"} ");
+            appendNumber(out, latency.count());
+            out += '\n';
+
+            out.append("http_request_duration_seconds_sum{");
+            appendRouteLabels(out, route);
+            out.append("} ");
+            appendSeconds(out, latency.sum());
+            out += '\n';
+
+            out.append("http_request_duration_seconds_count{");
+            appendRouteLabels(out, route);
+            out.append("} ");
+            appendNumber(out, latency.count());
+            out += '\n';
+        }
+
+        appendFamilyHeader(out, "http_request_duration_quantile_seconds", "gauge", "Handler latency percentiles since startup.");
+        for(size_t r = 0; r < _routes.size(); ++r)
+        {
+            for(const double quantile : exportedQuantiles)
+            {
+                char buf[16];
+                const auto result = std::to_chars(buf, buf + sizeof(buf), quantile);
+
+                out.append("http_request_duration_quantile_seconds{");
+                appendRouteLabels(out, _routes[r]);
+                out.append(",quantile=\"").append(buf, result.ptr - buf).append("\"} ");
+                appendSeconds(out, latencies[r].percentile(quantile * 100.0));
+                out += '\n';
+            }
+        }
+
+        appendFamilyHeader(out, "http_response_bytes_total", "counter", "Response bytes produced by the handler, including headers.");
+        for(const auto& route : _routes)
+        {
+            out.append("http_response_bytes_total{");
+            appendRouteLabels(out, route);
+            out.append("} ");
+            appendNumber(out, route.bytes());
+            out += '\n';
+        }
+
+        appendFamilyHeader(out, "http_requests_in_flight", "gauge", "Requests currently executing in a handler.");
+        for(const auto& route : _routes)
+        {
+            out.append("http_requests_in_flight{");
+            appendRouteLabels(out, route);
+            out.append("} ");
+            appendNumber(out, route.inFlight());
+            out += '\n';
+        }
+
+        for(const auto& counter : _counters)
+        {
+            appendFamilyHeader(out, counter.name().c_str(), "counter", counter.help());
+            out.append(counter.name()).append(" ");
+            appendNumber(out, counter.value());
+            out += '\n';
+        }
+
+        return out;
+    }
+}
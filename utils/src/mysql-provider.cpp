@@ -1,16 +1,157 @@
 #include "mysql-provider.h"
 
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
 #include <mysql_connection.h>
 #include <mysql_driver.h>
+#include <cppconn/exception.h>
 #include <cppconn/resultset.h>
 #include <cppconn/statement.h>
 #include <cppconn/prepared_statement.h>
 
+#include "flight-rows.h"
+#include "logger.h"
 #include "pointer-wrapper.h"
 #include "server-exceptions.h"
+#include "tracing.h"
 
 namespace Utils
 {
+    static const std::string usersRawStmt = "INSERT INTO users (name, password, type_id) VALUES (?,?,?)";
+    static const std::string pairsRawStmt = "INSERT INTO pairs (origin, destination, type, f_carrier) VALUES (?,?,?,?)";
+
+    // ER_DUP_ENTRY, raised when an insert collides with a UNIQUE key.
+    static constexpr int duplicateEntryError = 1062;
+
+    /**
+     * @brief "(?,?),(?,?),..." for a multi-row statement.
+     */
+    static std::string rowPlaceholders(size_t rows, std::string_view row)
+    {
+        std::string placeholders;
+        placeholders.reserve(rows * (row.size() + 1));
+        for(size_t i = 0; i < rows; ++i)
+        {
+            if(i != 0)
+            {
+                placeholders += ',';
+            }
+            placeholders += row;
+        }
+        return placeholders;
+    }
+
+    /**
+     * @brief The value lowercased, for comparing UNIQUE columns the way their case-insensitive
+     * collation does. Differences the collation ignores beyond ASCII case, e.g. accents, are
+     * left to the duplicate key error.
+     */
+    static std::string collationKey(std::string_view value)
+    {
+        std::string key(value);
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c)
+        {
+            return static_cast<char>(std::tolower(c));
+        });
+        return key;
+    }
+
+    namespace
+    {
+        /**
+         * Turns autocommit off for its lifetime and rolls back unless commit() was called.
+         */
+        class Transaction
+        {
+        public:
+            explicit Transaction(sql::Connection& connection) : _connection(connection)
+            {
+                _connection.setAutoCommit(false);
+            }
+
+            Transaction(const Transaction&) = delete;
+            Transaction& operator=(const Transaction&) = delete;
+
+            void commit()
+            {
+                _connection.commit();
+                _committed = true;
+            }
+
+            ~Transaction()
+            {
+                try
+                {
+                    if(!_committed)
+                    {
+                        _connection.rollback();
+                    }
+                    _connection.setAutoCommit(true);
+                }
+                catch(const sql::SQLException& e)
+                {
+                    LOG_ERROR("Failed to end a transaction: ", e.what());
+                }
+            }
+
+        private:
+            sql::Connection& _connection;
+            bool _committed = false;
+        };
+
+        /**
+         * Keeps the row triggers from bumping table_versions for its lifetime, so that a
+         * multi-row write can add its row count once through bumpTableVersion() instead.
+         */
+        class SkippedVersionBumps
+        {
+        public:
+            explicit SkippedVersionBumps(sql::Connection& connection) : _connection(connection)
+            {
+                PointerWrapper(_connection.createStatement())->execute("SET @skip_version_bump = 1");
+            }
+
+            SkippedVersionBumps(const SkippedVersionBumps&) = delete;
+            SkippedVersionBumps& operator=(const SkippedVersionBumps&) = delete;
+
+            ~SkippedVersionBumps()
+            {
+                try
+                {
+                    PointerWrapper(_connection.createStatement())->execute("SET @skip_version_bump = NULL");
+                }
+                catch(const sql::SQLException& e)
+                {
+                    LOG_ERROR("Failed to re-enable the table version triggers: ", e.what());
+                }
+            }
+
+        private:
+            sql::Connection& _connection;
+        };
+
+        void bumpTableVersion(sql::Connection& connection, Table table, size_t rows)
+        {
+            auto stmt = PointerWrapper(connection.prepareStatement("UPDATE table_versions SET version = version + ? WHERE name = ?"));
+            stmt->setUInt64(1, rows);
+            stmt->setString(2, std::string(getTableName(table)));
+            stmt->execute();
+        }
+    }
+
+    template<typename ResultSet>
+    static Pair readPairRow(ResultSet& row)
+    {
+        return Pair {
+            .origin = row.getString("origin"),
+            .destination = row.getString("destination"),
+            .type = row.getBoolean("type"),
+            .fareCarrier = row.getString("f_carrier")
+        };
+    }
+
     MySqlProvider::MySqlProvider(const std::string& dbHost, const int dbPort, const std::string& username, const std::string& password, const std::string& database) :
                         _dbHost(dbHost), _dbPort(dbPort), _username(username), _password(password), _database(database)
     {
@@ -19,15 +160,19 @@ namespace Utils
         _connection->setSchema(_database);
     }
 
-    bool MySqlProvider::isAuthenticated(const std::string& username,
-                                        const std::string& password)
+    bool MySqlProvider::isAuthenticated(std::string_view username,
+                                        std::string_view password)
     {
+        TRACE_SPAN("mysql.isAuthenticated");
+
         const std::string queryStr = "SELECT COUNT(*) AS user_count FROM users WHERE name=? AND password=?";
         try
         {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
             auto stmt = prepareStatement(queryStr);
-            stmt->setString(1, username);
-            stmt->setString(2, password);
+            stmt->setString(1, std::string(username));
+            stmt->setString(2, std::string(password));
             auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
 
             if (result->next())
@@ -43,14 +188,18 @@ namespace Utils
         }
     }
 
-    bool MySqlProvider::isAuthorized(const std::string& username,
+    bool MySqlProvider::isAuthorized(std::string_view username,
                                      UserType userType)
     {
+        TRACE_SPAN("mysql.isAuthorized");
+
         const std::string queryStr = "SELECT COUNT(*) AS user_count FROM users WHERE name=? AND type_id=?";
         try
         {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
             auto stmt = prepareStatement(queryStr);
-            stmt->setString(1, username);
+            stmt->setString(1, std::string(username));
             stmt->setInt(2, static_cast<int>(userType));
             auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
 
@@ -67,6 +216,671 @@ namespace Utils
         }
     }
 
+    void MySqlProvider::insertUser(const User& user)
+    {
+        LOG_DEBUG("Inserting user with username=", user.username,
+                  ", password=", user.password,
+                  ", type=", user.type,
+                  " using prepared statement ", usersRawStmt);
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = prepareStatement(usersRawStmt);
+            stmt->setString(1, user.username);
+            stmt->setString(2, user.password);
+            stmt->setInt(3, static_cast<int>(user.type));
+            stmt->execute();
+        }
+        catch(const sql::SQLException& e)
+        {
+            if(e.getErrorCode() == duplicateEntryError)
+            {
+                throw HttpStateConflict("User already exists.");
+            }
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    void MySqlProvider::insertUserUnsafe(const User& user)
+    {
+        const std::string queryStr = "INSERT INTO users (name, password, type_id) VALUES ('" + user.username + "','" + user.password + "'," + std::to_string(static_cast<int>(user.type)) + ")";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = createStatement();
+            stmt->execute(queryStr);
+        }
+        catch(const sql::SQLException& e)
+        {
+            if(e.getErrorCode() == duplicateEntryError)
+            {
+                throw HttpStateConflict("User already exists.");
+            }
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    void MySqlProvider::insertPair(const Pair& pair)
+    {
+        std::lock_guard<std::mutex> lock(_connectionMutex);
+
+        if(getPairLocked(pair.origin, pair.destination))
+        {
+            throw HttpStateConflict("Pair already exists.");
+        }
+
+        LOG_DEBUG("Inserting pair with origin=", pair.origin,
+                  ", destination=", pair.destination,
+                  ", type=", pair.type,
+                  ", fareCarrier=", pair.fareCarrier,
+                  " using prepared statement ", pairsRawStmt);
+
+        try
+        {
+            auto stmt = prepareStatement(pairsRawStmt);
+            stmt->setString(1, pair.origin);
+            stmt->setString(2, pair.destination);
+            stmt->setBoolean(3, pair.type);
+            stmt->setString(4, pair.fareCarrier);
+            stmt->execute();
+        }
+        catch(const sql::SQLException& e)
+        {
+            // Another process may have inserted the pair since the check above.
+            if(e.getErrorCode() == duplicateEntryError)
+            {
+                throw HttpStateConflict("Pair already exists.");
+            }
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    std::vector<bool> MySqlProvider::insertUsers(const std::vector<User>& users)
+    {
+        TRACE_SPAN("mysql.insertUsers");
+
+        std::vector<bool> inserted(users.size(), false);
+        if(users.empty())
+        {
+            return inserted;
+        }
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+            Transaction transaction(*_connection);
+
+            std::unordered_set<std::string> taken;
+            {
+                auto stmt = prepareStatement("SELECT name FROM users WHERE name IN (" + rowPlaceholders(users.size(), "?") + ") FOR UPDATE");
+                for(size_t i = 0; i < users.size(); ++i)
+                {
+                    stmt->setString(static_cast<int>(i + 1), users[i].username);
+                }
+
+                auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
+                while(result->next())
+                {
+                    taken.insert(collationKey(result->getString("name")));
+                }
+            }
+
+            std::vector<size_t> rows;
+            for(size_t i = 0; i < users.size(); ++i)
+            {
+                if(taken.insert(collationKey(users[i].username)).second)
+                {
+                    rows.push_back(i);
+                    inserted[i] = true;
+                }
+            }
+
+            if(!rows.empty())
+            {
+                LOG_DEBUG("Inserting ", rows.size(), " users using a single multi-row INSERT");
+
+                const SkippedVersionBumps skipped(*_connection);
+                const size_t added = insertRowsSkippingDuplicates(rows, inserted, "INSERT INTO users (name, password, type_id) VALUES ", "(?,?,?)",
+                                                                  [&users](sql::PreparedStatement& stmt, int& column, size_t i)
+                {
+                    stmt.setString(column++, users[i].username);
+                    stmt.setString(column++, users[i].password);
+                    stmt.setInt(column++, static_cast<int>(users[i].type));
+                });
+                bumpTableVersion(*_connection, Table::Users, added);
+            }
+
+            transaction.commit();
+            return inserted;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    std::vector<bool> MySqlProvider::insertPairs(const std::vector<Pair>& pairs)
+    {
+        TRACE_SPAN("mysql.insertPairs");
+
+        std::vector<bool> inserted(pairs.size(), false);
+        if(pairs.empty())
+        {
+            return inserted;
+        }
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+            Transaction transaction(*_connection);
+
+            std::unordered_set<std::string> taken;
+            {
+                auto stmt = prepareStatement("SELECT origin, destination FROM pairs WHERE (origin, destination) IN (" +
+                                             rowPlaceholders(pairs.size(), "(?,?)") + ") FOR UPDATE");
+                int column = 1;
+                for(const Pair& pair : pairs)
+                {
+                    stmt->setString(column++, pair.origin);
+                    stmt->setString(column++, pair.destination);
+                }
+
+                auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
+                while(result->next())
+                {
+                    taken.insert(collationKey(std::string(result->getString("origin")) + '-' + std::string(result->getString("destination"))));
+                }
+            }
+
+            std::vector<size_t> rows;
+            for(size_t i = 0; i < pairs.size(); ++i)
+            {
+                if(taken.insert(collationKey(pairs[i].origin + '-' + pairs[i].destination)).second)
+                {
+                    rows.push_back(i);
+                    inserted[i] = true;
+                }
+            }
+
+            if(!rows.empty())
+            {
+                LOG_DEBUG("Inserting ", rows.size(), " pairs using a single multi-row INSERT");
+
+                const SkippedVersionBumps skipped(*_connection);
+                const size_t added = insertRowsSkippingDuplicates(rows, inserted, "INSERT INTO pairs (origin, destination, type, f_carrier) VALUES ", "(?,?,?,?)",
+                                                                  [&pairs](sql::PreparedStatement& stmt, int& column, size_t i)
+                {
+                    stmt.setString(column++, pairs[i].origin);
+                    stmt.setString(column++, pairs[i].destination);
+                    stmt.setBoolean(column++, pairs[i].type);
+                    stmt.setString(column++, pairs[i].fareCarrier);
+                });
+                bumpTableVersion(*_connection, Table::Pairs, added);
+            }
+
+            transaction.commit();
+            return inserted;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    size_t MySqlProvider::insertRowsSkippingDuplicates(const std::vector<size_t>& rows, std::vector<bool>& inserted,
+                                                       const std::string& insertPrefix, std::string_view rowPlaceholder,
+                                                       const std::function<void(sql::PreparedStatement&, int&, size_t)>& bindRow)
+    {
+        try
+        {
+            auto stmt = prepareStatement(insertPrefix + rowPlaceholders(rows.size(), rowPlaceholder));
+            int column = 1;
+            for(const size_t row : rows)
+            {
+                bindRow(*stmt, column, row);
+            }
+            stmt->execute();
+            return rows.size();
+        }
+        catch(const sql::SQLException& e)
+        {
+            if(e.getErrorCode() != duplicateEntryError)
+            {
+                throw;
+            }
+        }
+
+        // A key the check before missed, e.g. one differing only in accents. MySQL rolled back
+        // just the failed statement, so the rows go in one by one and the duplicates are skipped.
+        LOG_DEBUG("The multi-row INSERT hit a duplicate key, inserting ", rows.size(), " rows one by one");
+
+        size_t added = 0;
+        auto stmt = prepareStatement(insertPrefix + std::string(rowPlaceholder));
+        for(const size_t row : rows)
+        {
+            int column = 1;
+            bindRow(*stmt, column, row);
+            try
+            {
+                stmt->execute();
+                ++added;
+            }
+            catch(const sql::SQLException& e)
+            {
+                if(e.getErrorCode() != duplicateEntryError)
+                {
+                    throw;
+                }
+                inserted[row] = false;
+            }
+        }
+        return added;
+    }
+
+    std::vector<User> MySqlProvider::getUsers()
+    {
+        const std::string queryStr = "SELECT * FROM users";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = createStatement();
+            auto result = PointerWrapper(stmt->executeQuery(queryStr));
+
+            std::vector<User> users;
+            users.reserve(result->rowsCount());
+
+            while(result->next())
+            {
+                users.push_back(User {
+                    .username = result->getString("name"),
+                    .password = result->getString("password"),
+                    .type = static_cast<UserType>(result->getInt("type_id"))
+                });
+            }
+
+            return users;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    std::vector<Pair> MySqlProvider::getPairs()
+    {
+        const std::string queryStr = "SELECT * FROM pairs";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = createStatement();
+            auto result = PointerWrapper(stmt->executeQuery(queryStr));
+
+            std::vector<Pair> pairs;
+            pairs.reserve(result->rowsCount());
+
+            while(result->next())
+            {
+                pairs.push_back(readPairRow(*result));
+            }
+
+            return pairs;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    Page<User> MySqlProvider::getUsersPage(uint64_t afterId, size_t limit)
+    {
+        // One row more than asked for tells whether another page follows.
+        const std::string queryStr = "SELECT id, name, password, type_id FROM users WHERE id > ? ORDER BY id LIMIT ?";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = prepareStatement(queryStr);
+            stmt->setUInt64(1, afterId);
+            stmt->setUInt64(2, limit + 1);
+            auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
+
+            Page<User> page;
+            page.lastId = afterId;
+            page.records.reserve(limit);
+            while(result->next())
+            {
+                if(page.records.size() == limit)
+                {
+                    page.hasMore = true;
+                    break;
+                }
+
+                page.lastId = result->getUInt64("id");
+                page.records.push_back(User {
+                    .username = result->getString("name"),
+                    .password = result->getString("password"),
+                    .type = static_cast<UserType>(result->getInt("type_id"))
+                });
+            }
+
+            return page;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    Page<Pair> MySqlProvider::getPairsPage(uint64_t afterId, size_t limit)
+    {
+        const std::string queryStr = "SELECT * FROM pairs WHERE id > ? ORDER BY id LIMIT ?";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = prepareStatement(queryStr);
+            stmt->setUInt64(1, afterId);
+            stmt->setUInt64(2, limit + 1);
+            auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
+
+            Page<Pair> page;
+            page.lastId = afterId;
+            page.records.reserve(limit);
+            while(result->next())
+            {
+                if(page.records.size() == limit)
+                {
+                    page.hasMore = true;
+                    break;
+                }
+
+                page.lastId = result->getUInt64("id");
+                page.records.push_back(readPairRow(*result));
+            }
+
+            return page;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    std::optional<Pair> MySqlProvider::getPair(const std::string& origin, const std::string& destination)
+    {
+        std::lock_guard<std::mutex> lock(_connectionMutex);
+        return getPairLocked(origin, destination);
+    }
+
+    std::optional<Pair> MySqlProvider::getPairLocked(const std::string& origin, const std::string& destination)
+    {
+        const std::string queryStr = "SELECT * FROM pairs WHERE origin='" + origin + "' AND destination='" + destination + "'";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            auto stmt = createStatement();
+            auto result = PointerWrapper(stmt->executeQuery(queryStr));
+
+            if(result->next())
+            {
+                return readPairRow(*result);
+            }
+
+            return std::nullopt;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    std::vector<Pair> MySqlProvider::getPairsUnsafe(const std::string& origin, const std::string& destination)
+    {
+        const std::string queryStr = "SELECT * FROM pairs WHERE origin='" + origin + "' AND destination='" + destination + "'";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = createStatement();
+            auto result = PointerWrapper(stmt->executeQuery(queryStr));
+
+            std::vector<Pair> pairs;
+            while(result->next())
+            {
+                pairs.push_back(readPairRow(*result));
+            }
+
+            return pairs;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    std::vector<Flight> MySqlProvider::getFlights(const std::string& origin, const std::string& destination)
+    {
+        const bool setOrigin = !origin.empty();
+        const bool setDestination = !destination.empty();
+
+        std::string queryStr = "SELECT p.origin AS origin, "
+                                      "p.destination AS destination, "
+                                      "p.type AS type, "
+                                      "p.f_carrier AS f_carrier, "
+                                      "f.dep_datetime AS dep_datetime, "
+                                      "f.arr_datetime AS arr_datetime, "
+                                      "f.price AS price, "
+                                      "f.currency AS currency, "
+                                      "f.cabin AS cabin "
+                               "FROM flights f JOIN pairs p ON f.pair_id = p.id";
+
+        if(setOrigin || setDestination)
+        {
+            queryStr += " WHERE ";
+
+            if(setOrigin)
+            {
+                queryStr += "origin='" + origin + "'";
+                if(setDestination)
+                {
+                    queryStr += " AND ";
+                }
+            }
+
+            if(setDestination)
+            {
+                queryStr += "destination='" + destination + "'";
+            }
+        }
+
+        queryStr += ";";
+
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = createStatement();
+            auto result = [&]()
+            {
+                TRACE_SPAN("mysql.flightsJoin");
+                return PointerWrapper(stmt->executeQuery(queryStr));
+            }();
+
+            TRACE_SPAN("mysql.readFlights");
+            return readFlightRows(*result);
+        }
+        catch(const std::exception& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    Page<Flight> MySqlProvider::getFlightsPage(uint64_t afterId, size_t limit)
+    {
+        const std::string queryStr = "SELECT f.id AS id, "
+                                            "p.origin AS origin, "
+                                            "p.destination AS destination, "
+                                            "p.type AS type, "
+                                            "p.f_carrier AS f_carrier, "
+                                            "f.dep_datetime AS dep_datetime, "
+                                            "f.arr_datetime AS arr_datetime, "
+                                            "f.price AS price, "
+                                            "f.currency AS currency, "
+                                            "f.cabin AS cabin "
+                                     "FROM flights f JOIN pairs p ON f.pair_id = p.id "
+                                     "WHERE f.id > ? ORDER BY f.id LIMIT ?";
+        LOG_DEBUG("Executing query ", queryStr);
+
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = prepareStatement(queryStr);
+            stmt->setUInt64(1, afterId);
+            stmt->setUInt64(2, limit + 1);
+            auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
+
+            Page<Flight> page;
+            page.lastId = afterId;
+            page.records.reserve(limit);
+            while(result->next())
+            {
+                if(page.records.size() == limit)
+                {
+                    page.hasMore = true;
+                    break;
+                }
+
+                page.lastId = result->getUInt64("id");
+                page.records.push_back(readFlightRow(*result));
+            }
+
+            return page;
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    void MySqlProvider::insertMissingFlights(const std::function<Flight(const Pair&)>& makeFlight)
+    {
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            std::vector<std::pair<int, Pair>> pairs;
+            {
+                const std::string queryStr = "SELECT * FROM pairs";
+                LOG_DEBUG("Executing query ", queryStr);
+
+                auto stmt = createStatement();
+                auto result = PointerWrapper(stmt->executeQuery(queryStr));
+
+                while(result->next())
+                {
+                    pairs.emplace_back(result->getInt("id"), readPairRow(*result));
+                }
+            }
+
+            {
+                std::vector<int> pairIdsInFlights;
+                const std::string queryStr = "SELECT pair_id FROM flights";
+                LOG_DEBUG("Executing query ", queryStr);
+
+                auto stmt = createStatement();
+                auto result = PointerWrapper(stmt->executeQuery(queryStr));
+
+                while(result->next())
+                {
+                    pairIdsInFlights.push_back(result->getInt("pair_id"));
+                }
+
+                // Remove pairs that are already present in pairIdsInFlights
+                pairs.erase(std::remove_if(pairs.begin(), pairs.end(), [&pairIdsInFlights](const std::pair<int, Pair>& pair) {
+                                           return std::find(pairIdsInFlights.begin(), pairIdsInFlights.end(), pair.first) != pairIdsInFlights.end();}),
+                            pairs.end());
+            }
+
+            if (pairs.empty())
+            {
+                LOG_DEBUG("No new pairs to insert into flights table.");
+                return;
+            }
+
+            std::string insertQuery = "INSERT INTO flights (pair_id, dep_datetime, arr_datetime, price, currency, cabin) VALUES ";
+
+            for(const auto& [pairId, pair] : pairs)
+            {
+                const Flight flight = makeFlight(pair);
+
+                insertQuery += "(" + std::to_string(pairId) + ", '" + flight.departureTime + "', '" + flight.arrivalTime + "', " +
+                               std::to_string(flight.price) + ", '" + flight.currency + "', " + std::to_string(static_cast<int>(flight.cabin)) + "),";
+            }
+
+            insertQuery.pop_back();
+            insertQuery += ";";
+
+            LOG_DEBUG("Inserting flights for ", pairs.size(), " pairs using a single multi-row INSERT");
+
+            Transaction transaction(*_connection);
+            const SkippedVersionBumps skipped(*_connection);
+            auto stmt = createStatement();
+            stmt->execute(insertQuery);
+            bumpTableVersion(*_connection, Table::Flights, pairs.size());
+            transaction.commit();
+        }
+        catch(const sql::SQLException& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
+    uint64_t MySqlProvider::getTableVersion(Table table)
+    {
+        TRACE_SPAN("mysql.getTableVersion");
+
+        const std::string queryStr = "SELECT version FROM table_versions WHERE name=?";
+        try
+        {
+            std::lock_guard<std::mutex> lock(_connectionMutex);
+
+            auto stmt = prepareStatement(queryStr);
+            stmt->setString(1, std::string(getTableName(table)));
+            auto result = PointerWrapper<sql::ResultSet>(stmt->executeQuery());
+
+            if(result->next())
+            {
+                return result->getUInt64("version");
+            }
+
+            return 0;
+        }
+        catch(const std::exception& e)
+        {
+            throw HttpInternalServerError(e.what());
+        }
+    }
+
     PointerWrapper<sql::Statement> MySqlProvider::createStatement()
     {
         return PointerWrapper(_connection->createStatement());
@@ -74,6 +888,7 @@ namespace Utils
 
     PointerWrapper<sql::PreparedStatement> MySqlProvider::prepareStatement(const std::string& stmtStr)
     {
+        TRACE_SPAN("mysql.prepareStatement");
         return PointerWrapper(_connection->prepareStatement(stmtStr));
     }
 
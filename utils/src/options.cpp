@@ -8,12 +8,50 @@ namespace Utils
         _op.add<popl::Value<int>, popl::Attribute::required>("p", "global.port", "The server port number");
         _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "global.max_request_streambuf_size", "", 1000);
         _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "global.thread_pool_size", "", 1);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "global.acceptors", "Independent SO_REUSEPORT listeners, each with its own io_context and thread_pool_size threads.", 1);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "global.listen_tcp", "0 to listen on unix_socket only.", 1);
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "global.unix_socket", "A Unix domain socket path to listen on as well, for clients on the same host. Empty for none.", "");
         _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "global.timeout_content", "", 0);
         _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "global.timeout_request", "", 0);
 
         _op.add<popl::Value<std::string>, popl::Attribute::required>("", "security.certificate_path", "", "server.crt");
         _op.add<popl::Value<std::string>, popl::Attribute::required>("", "security.private_key_path", "", "server.key");
-        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "security.blacklisted_ips", "A comma-separated list of blacklisted IP addresses.");
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "security.blacklisted_ips", "A comma-separated list of blocked IP addresses and CIDR ranges, e.g. 10.0.0.0/8,2001:db8::/32.", "");
+
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "schemas.reload_interval_ms", "How often to check JSON schema files for changes, 0 disables hot reload.", 0);
+
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "affinity.io_cpus", "CPUs to pin the I/O threads to, one each, e.g. 0-3. Empty leaves them unpinned.", "");
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "affinity.worker_cpus", "CPUs for every other thread, e.g. 4-7. Empty leaves them unpinned.", "");
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "affinity.numa_local", "1 to allocate the memory of each thread on its own NUMA node.", 0);
+
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "logging.level", "One of debug, info, warning, error or off.", "info");
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "logging.debug_sample_rate", "Keep only every N-th debug message per thread.", 1);
+
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tracing.ring_size", "Spans kept per thread for on-demand dumps, 0 disables tracing.", 0);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tracing.sample_rate", "Write the trace of every N-th request to output_dir, 0 disables sampling.", 0);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tracing.slow_request_ms", "Write the trace of requests slower than this to output_dir, 0 disables it.", 0);
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "tracing.output_dir", "Where captured request traces are written.", "traces");
+
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "compression.level", "zlib level from 1 to 9 for gzip and deflate responses, 0 disables compression.", 6);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "compression.min_size", "Responses smaller than this many bytes are sent uncompressed.", 1024);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "compression.cache_entries", "How many recently compressed bodies to keep, 0 disables the cache.", 16);
+
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "currency.rates", "Comma-separated CODE:RATE pairs, the units of each currency one unit of a common base buys, for the currency query parameter.", "USD:1,EUR:0.92,GBP:0.79,BGN:1.80");
+
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "import.batch_size", "Records inserted per transaction by the bulk import endpoints.", 1000);
+
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "changes.capacity", "How many of the latest insertions GET /config/changes can replay.", 10000);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "changes.max_wait_s", "The longest a long-poll waits for changes and the heartbeat interval of event streams.", 30);
+
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tls.session_cache_size", "TLS sessions cached by the server for resumption, 0 disables the cache.", 20480);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tls.session_timeout_s", "How long a TLS session or ticket can be resumed.", 300);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tls.session_tickets", "1 to issue TLS session tickets, 0 to rely on the session cache only.", 1);
+        _op.add<popl::Value<unsigned int>, popl::Attribute::optional>("", "tls.ticket_key_rotation_s", "How often the session ticket encryption key is replaced.", 3600);
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "tls.ciphers", "OpenSSL cipher list for TLS 1.2, empty for the OpenSSL default.", "");
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "tls.ciphersuites", "OpenSSL ciphersuites for TLS 1.3, empty for the OpenSSL default.", "");
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "tls.curves", "Colon-separated key exchange groups, empty for the OpenSSL default.", "");
+
+        _op.add<popl::Value<std::string>, popl::Attribute::optional>("", "storage.backend", "Either mysql or memory.", "mysql");
 
         _op.add<popl::Value<std::string>, popl::Attribute::required>("", "mysql.host", "The host used to connect to the MySQL database.", "127.0.0.1");
         _op.add<popl::Value<int>, popl::Attribute::required>("", "mysql.port", "The port used to connect to the MySQL database.", 3306);
@@ -44,6 +82,21 @@ namespace Utils
         return _op.get_option<popl::Value<unsigned int>>("global.thread_pool_size")->value();
     }
 
+    unsigned int Options::getAcceptors() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("global.acceptors")->value();
+    }
+
+    bool Options::getListenTcp() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("global.listen_tcp")->value() != 0;
+    }
+
+    std::string Options::getUnixSocket() const
+    {
+        return _op.get_option<popl::Value<std::string>>("global.unix_socket")->value();
+    }
+
     unsigned int Options::getTimeoutContent() const
     {
         return _op.get_option<popl::Value<unsigned int>>("global.timeout_content")->value();
@@ -64,24 +117,153 @@ namespace Utils
         return _op.get_option<popl::Value<std::string>>("security.private_key_path")->value();
     }
 
-    std::set<std::string> Options::getBlacklistedIPs() const
+    std::set<std::string> parseIPList(std::string ips)
     {
-        std::set<std::string> blacklistedIPs;
-        auto ips = _op.get_option<popl::Value<std::string>>("security.blacklisted_ips")->value();
+        std::set<std::string> result;
         if (!ips.empty())
         {
             size_t pos = 0;
             while ((pos = ips.find(',')) != std::string::npos)
             {
-                blacklistedIPs.insert(ips.substr(0, pos));
+                result.insert(ips.substr(0, pos));
                 ips.erase(0, pos + 1);
             }
             if (!ips.empty())
             {
-                blacklistedIPs.insert(ips);
+                result.insert(ips);
             }
         }
-        return blacklistedIPs;
+        return result;
+    }
+
+    std::set<std::string> Options::getBlacklistedIPs() const
+    {
+        return parseIPList(_op.get_option<popl::Value<std::string>>("security.blacklisted_ips")->value());
+    }
+
+    unsigned int Options::getSchemaReloadInterval() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("schemas.reload_interval_ms")->value();
+    }
+
+    std::vector<unsigned int> Options::getIoCpus() const
+    {
+        return parseCpuList(_op.get_option<popl::Value<std::string>>("affinity.io_cpus")->value());
+    }
+
+    std::vector<unsigned int> Options::getWorkerCpus() const
+    {
+        return parseCpuList(_op.get_option<popl::Value<std::string>>("affinity.worker_cpus")->value());
+    }
+
+    bool Options::getNumaLocal() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("affinity.numa_local")->value() != 0;
+    }
+
+    LogLevel Options::getLogLevel() const
+    {
+        return parseLogLevel(_op.get_option<popl::Value<std::string>>("logging.level")->value());
+    }
+
+    unsigned int Options::getDebugSampleRate() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("logging.debug_sample_rate")->value();
+    }
+
+    unsigned int Options::getTraceRingSize() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tracing.ring_size")->value();
+    }
+
+    unsigned int Options::getTraceSampleRate() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tracing.sample_rate")->value();
+    }
+
+    unsigned int Options::getTraceSlowRequestMs() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tracing.slow_request_ms")->value();
+    }
+
+    std::string Options::getTraceOutputDir() const
+    {
+        return _op.get_option<popl::Value<std::string>>("tracing.output_dir")->value();
+    }
+
+    unsigned int Options::getCompressionLevel() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("compression.level")->value();
+    }
+
+    unsigned int Options::getCompressionMinSize() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("compression.min_size")->value();
+    }
+
+    unsigned int Options::getCompressionCacheEntries() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("compression.cache_entries")->value();
+    }
+
+    std::string Options::getExchangeRates() const
+    {
+        return _op.get_option<popl::Value<std::string>>("currency.rates")->value();
+    }
+
+    unsigned int Options::getImportBatchSize() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("import.batch_size")->value();
+    }
+
+    unsigned int Options::getChangeLogCapacity() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("changes.capacity")->value();
+    }
+
+    unsigned int Options::getChangesMaxWait() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("changes.max_wait_s")->value();
+    }
+
+    unsigned int Options::getTlsSessionCacheSize() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tls.session_cache_size")->value();
+    }
+
+    unsigned int Options::getTlsSessionTimeout() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tls.session_timeout_s")->value();
+    }
+
+    bool Options::getTlsSessionTickets() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tls.session_tickets")->value() != 0;
+    }
+
+    unsigned int Options::getTlsTicketKeyRotation() const
+    {
+        return _op.get_option<popl::Value<unsigned int>>("tls.ticket_key_rotation_s")->value();
+    }
+
+    std::string Options::getTlsCiphers() const
+    {
+        return _op.get_option<popl::Value<std::string>>("tls.ciphers")->value();
+    }
+
+    std::string Options::getTlsCiphersuites() const
+    {
+        return _op.get_option<popl::Value<std::string>>("tls.ciphersuites")->value();
+    }
+
+    std::string Options::getTlsCurves() const
+    {
+        return _op.get_option<popl::Value<std::string>>("tls.curves")->value();
+    }
+
+    std::string Options::getStorageBackend() const
+    {
+        return _op.get_option<popl::Value<std::string>>("storage.backend")->value();
     }
 
     std::string Options::getMySqlHost() const
@@ -0,0 +1,83 @@
+#include "price-calendar.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "flight-wire.h"
+
+namespace Utils
+{
+    void PriceCalendar::add(const Flight& flight)
+    {
+        const int64_t departure = parseDateTime(flight.departureTime);
+        const int64_t day = departure >= 0 ? departure / 86400 : (departure - 86399) / 86400;
+        const int64_t priceTicks = std::llround(flight.price * flightPriceScale);
+
+        std::vector<Series>& pair = _pairs[pairKey(flight.origin, flight.destination)];
+        auto series = std::find_if(pair.begin(), pair.end(), [&flight](const Series& s)
+        {
+            return s.currency == flight.currency;
+        });
+        if(series == pair.end())
+        {
+            series = pair.insert(pair.end(), Series { .currency = flight.currency, .firstDay = day, .cells = {} });
+        }
+
+        // Grow the array to cover the day, on whichever side it falls.
+        const int64_t firstDay = std::min(series->firstDay, day);
+        const int64_t endDay = std::max<int64_t>(series->firstDay + static_cast<int64_t>(series->cells.size()), day + 1);
+        if(endDay - firstDay > maxSpanDays)
+        {
+            throw std::invalid_argument("Departure " + flight.departureTime + " is too far from the other " +
+                                        flight.origin + "-" + flight.destination + " flights.");
+        }
+        if(firstDay < series->firstDay)
+        {
+            series->cells.insert(series->cells.begin(), static_cast<size_t>(series->firstDay - firstDay), Cell());
+            series->firstDay = firstDay;
+        }
+        series->cells.resize(static_cast<size_t>(endDay - firstDay));
+
+        Cell& cell = series->cells[static_cast<size_t>(day - series->firstDay)];
+        cell.priceTicks = std::min(cell.priceTicks, priceTicks);
+        ++cell.flights;
+        ++_flightCount;
+    }
+
+    std::vector<CalendarDay> PriceCalendar::lookup(std::string_view origin, std::string_view destination, int64_t fromDay, int64_t toDay) const
+    {
+        std::vector<CalendarDay> days;
+
+        const auto it = _pairs.find(pairKey(origin, destination));
+        if(it == _pairs.end() || toDay < fromDay)
+        {
+            return days;
+        }
+
+        for(const Series& series : it->second)
+        {
+            const int64_t first = std::max(fromDay, series.firstDay);
+            const int64_t last = std::min(toDay, series.firstDay + static_cast<int64_t>(series.cells.size()) - 1);
+            for(int64_t day = first; day <= last; ++day)
+            {
+                const Cell& cell = series.cells[static_cast<size_t>(day - series.firstDay)];
+                if(cell.flights != 0)
+                {
+                    days.push_back(CalendarDay { .day = day, .priceTicks = cell.priceTicks, .currency = series.currency, .flights = cell.flights });
+                }
+            }
+        }
+
+        // Each series is in date order already, so this only interleaves the currencies.
+        if(it->second.size() > 1)
+        {
+            std::stable_sort(days.begin(), days.end(), [](const CalendarDay& x, const CalendarDay& y)
+            {
+                return x.day < y.day;
+            });
+        }
+
+        return days;
+    }
+}
@@ -0,0 +1,362 @@
+#include "route-engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <tuple>
+
+#include "flight-wire.h"
+#include "json-writer.h"
+
+namespace Utils
+{
+    namespace
+    {
+        // Edges examined per search before it gives up on finding anything better.
+        constexpr size_t expansionBudget = 1 << 20;
+
+        constexpr uint32_t noCurrency = std::numeric_limits<uint32_t>::max();
+        constexpr int64_t unreachablePrice = std::numeric_limits<int64_t>::max();
+        constexpr unsigned int unreachableLegs = std::numeric_limits<unsigned int>::max();
+    }
+
+    class RouteGraph::Search
+    {
+    public:
+        Search(const RouteGraph& graph, const RouteQuery& query, uint32_t origin, uint32_t destination)
+            : _graph(graph),
+              _query(query),
+              _destination(destination),
+              _minLegs(graph.airportCount(), unreachableLegs),
+              _minPrice(graph.airportCount(), unreachablePrice),
+              _visited(graph.airportCount(), false)
+        {
+            computeBounds();
+            _visited[origin] = true;
+            _origin = origin;
+        }
+
+        RouteSearchResult run()
+        {
+            if(_query.limit > 0 && _minLegs[_origin] <= _query.maxLegs)
+            {
+                expand(_origin, std::numeric_limits<int64_t>::min(), 0, 0, noCurrency);
+            }
+
+            _result.complete = _expansions <= expansionBudget;
+            return std::move(_result);
+        }
+
+    private:
+        // Compared lexicographically, with the query's objective deciding which comes first.
+        using Key = std::tuple<int64_t, int64_t, int64_t>;
+
+        Key keyOf(unsigned int legs, int64_t price, int64_t arrival) const
+        {
+            return _query.objective == RouteObjective::FewestStops ? Key(legs, price, arrival) : Key(price, legs, arrival);
+        }
+
+        Key keyOf(const Itinerary& itinerary) const
+        {
+            return keyOf(static_cast<unsigned int>(itinerary.legs.size()), itinerary.priceTicks, itinerary.arrivalTime);
+        }
+
+        /**
+         * @brief Fewest legs and lowest price from every airport to the destination, ignoring
+         * schedules and currencies, by searching backwards from it.
+         */
+        void computeBounds()
+        {
+            _minLegs[_destination] = 0;
+            std::vector<uint32_t> frontier = { _destination };
+            for(unsigned int legs = 1; legs <= _query.maxLegs && !frontier.empty(); ++legs)
+            {
+                std::vector<uint32_t> next;
+                for(const uint32_t airport : frontier)
+                {
+                    for(uint32_t e = _graph._reverseOffsets[airport]; e < _graph._reverseOffsets[airport + 1]; ++e)
+                    {
+                        const uint32_t origin = _graph._reverseEdges[e].origin;
+                        if(_minLegs[origin] == unreachableLegs)
+                        {
+                            _minLegs[origin] = legs;
+                            next.push_back(origin);
+                        }
+                    }
+                }
+                frontier = std::move(next);
+            }
+
+            using Entry = std::pair<int64_t, uint32_t>;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+            _minPrice[_destination] = 0;
+            queue.emplace(0, _destination);
+            while(!queue.empty())
+            {
+                const auto [price, airport] = queue.top();
+                queue.pop();
+                if(price > _minPrice[airport])
+                {
+                    continue;
+                }
+
+                for(uint32_t e = _graph._reverseOffsets[airport]; e < _graph._reverseOffsets[airport + 1]; ++e)
+                {
+                    const ReverseEdge& edge = _graph._reverseEdges[e];
+                    if(_minLegs[edge.origin] != unreachableLegs && price + edge.price < _minPrice[edge.origin])
+                    {
+                        _minPrice[edge.origin] = price + edge.price;
+                        queue.emplace(_minPrice[edge.origin], edge.origin);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Whether a partial itinerary whose best completion costs at least the given
+         * legs and price can still make it into the results.
+         */
+        bool promising(unsigned int legs, int64_t price) const
+        {
+            if(_result.itineraries.size() < _query.limit)
+            {
+                return true;
+            }
+
+            const Key worst = keyOf(_result.itineraries.back());
+            const Key bound = keyOf(legs, price, std::numeric_limits<int64_t>::min());
+            return std::make_pair(std::get<0>(bound), std::get<1>(bound)) <= std::make_pair(std::get<0>(worst), std::get<1>(worst));
+        }
+
+        void record(int64_t price, int64_t arrival)
+        {
+            auto& itineraries = _result.itineraries;
+            const Key key = keyOf(static_cast<unsigned int>(_path.size()), price, arrival);
+            if(itineraries.size() == _query.limit && !(key < keyOf(itineraries.back())))
+            {
+                return;
+            }
+
+            Itinerary itinerary;
+            itinerary.legs.reserve(_path.size());
+            for(const uint32_t edge : _path)
+            {
+                itinerary.legs.push_back(_graph._edges[edge].flight);
+            }
+            itinerary.priceTicks = price;
+            itinerary.departureTime = _graph._edges[_path.front()].departure;
+            itinerary.arrivalTime = arrival;
+
+            const auto position = std::upper_bound(itineraries.begin(), itineraries.end(), key, [this](const Key& k, const Itinerary& other)
+            {
+                return k < keyOf(other);
+            });
+            itineraries.insert(position, std::move(itinerary));
+            if(itineraries.size() > _query.limit)
+            {
+                itineraries.pop_back();
+            }
+        }
+
+        void expand(uint32_t airport, int64_t readyTime, unsigned int legs, int64_t price, uint32_t currency)
+        {
+            const Edge* begin = _graph._edges.data() + _graph._offsets[airport];
+            const Edge* end = _graph._edges.data() + _graph._offsets[airport + 1];
+            begin = std::partition_point(begin, end, [readyTime](const Edge& edge)
+            {
+                return edge.departure < readyTime;
+            });
+
+            for(const Edge* edge = begin; edge != end; ++edge)
+            {
+                if(++_expansions > expansionBudget)
+                {
+                    return;
+                }
+
+                const uint32_t next = edge->destination;
+                if(_visited[next] || (currency != noCurrency && edge->currency != currency))
+                {
+                    continue;
+                }
+
+                const unsigned int nextLegs = legs + 1;
+                const int64_t nextPrice = price + edge->price;
+                if(nextLegs + _minLegs[next] > _query.maxLegs || _minLegs[next] == unreachableLegs ||
+                   !promising(nextLegs + _minLegs[next], nextPrice + _minPrice[next]))
+                {
+                    continue;
+                }
+
+                _path.push_back(static_cast<uint32_t>(edge - _graph._edges.data()));
+                if(next == _destination)
+                {
+                    record(nextPrice, edge->arrival);
+                }
+                else
+                {
+                    _visited[next] = true;
+                    expand(next, edge->arrival + _query.minConnectionSeconds, nextLegs, nextPrice, edge->currency);
+                    _visited[next] = false;
+                }
+                _path.pop_back();
+            }
+        }
+
+        const RouteGraph& _graph;
+        const RouteQuery& _query;
+        uint32_t _origin = 0;
+        const uint32_t _destination;
+
+        std::vector<unsigned int> _minLegs;
+        std::vector<int64_t> _minPrice;
+        std::vector<bool> _visited;
+
+        std::vector<uint32_t> _path; // edge indices
+        size_t _expansions = 0;
+        RouteSearchResult _result;
+    };
+
+    RouteGraph::RouteGraph(std::vector<Flight> flights)
+        : _flights(std::move(flights))
+    {
+        const auto intern = [this](const std::string& code)
+        {
+            const auto [it, inserted] = _airportIndex.emplace(code, static_cast<uint32_t>(_airports.size()));
+            if(inserted)
+            {
+                _airports.push_back(code);
+            }
+            return it->second;
+        };
+
+        std::unordered_map<std::string, uint32_t> currencies;
+
+        std::vector<uint32_t> origins;
+        origins.reserve(_flights.size());
+        std::vector<Edge> edges;
+        edges.reserve(_flights.size());
+
+        for(size_t i = 0; i < _flights.size(); ++i)
+        {
+            const Flight& flight = _flights[i];
+            origins.push_back(intern(flight.origin));
+            edges.push_back(Edge {
+                .departure = parseDateTime(flight.departureTime),
+                .arrival = parseDateTime(flight.arrivalTime),
+                .price = std::llround(flight.price * flightPriceScale),
+                .destination = intern(flight.destination),
+                .flight = static_cast<uint32_t>(i),
+                .currency = currencies.emplace(flight.currency, static_cast<uint32_t>(currencies.size())).first->second
+            });
+        }
+
+        // Counting sort by origin into the CSR layout.
+        const size_t airports = _airports.size();
+        _offsets.assign(airports + 1, 0);
+        for(const uint32_t origin : origins)
+        {
+            ++_offsets[origin + 1];
+        }
+        for(size_t a = 0; a < airports; ++a)
+        {
+            _offsets[a + 1] += _offsets[a];
+        }
+
+        _edges.resize(edges.size());
+        std::vector<uint32_t> cursor(_offsets.begin(), _offsets.end() - 1);
+        for(size_t i = 0; i < edges.size(); ++i)
+        {
+            _edges[cursor[origins[i]]++] = edges[i];
+        }
+        for(size_t a = 0; a < airports; ++a)
+        {
+            std::sort(_edges.begin() + _offsets[a], _edges.begin() + _offsets[a + 1], [](const Edge& x, const Edge& y)
+            {
+                return x.departure < y.departure;
+            });
+        }
+
+        // The reverse graph keeps only the cheapest edge between two airports.
+        std::vector<std::tuple<uint32_t, uint32_t, int64_t>> reverse; // destination, origin, price
+        reverse.reserve(_edges.size());
+        for(size_t a = 0; a < airports; ++a)
+        {
+            for(uint32_t e = _offsets[a]; e < _offsets[a + 1]; ++e)
+            {
+                reverse.emplace_back(_edges[e].destination, static_cast<uint32_t>(a), _edges[e].price);
+            }
+        }
+        std::sort(reverse.begin(), reverse.end());
+        reverse.erase(std::unique(reverse.begin(), reverse.end(), [](const auto& x, const auto& y)
+        {
+            return std::get<0>(x) == std::get<0>(y) && std::get<1>(x) == std::get<1>(y);
+        }), reverse.end());
+
+        _reverseOffsets.assign(airports + 1, 0);
+        _reverseEdges.reserve(reverse.size());
+        for(const auto& [destination, origin, price] : reverse)
+        {
+            ++_reverseOffsets[destination + 1];
+            _reverseEdges.push_back(ReverseEdge { .origin = origin, .price = price });
+        }
+        for(size_t a = 0; a < airports; ++a)
+        {
+            _reverseOffsets[a + 1] += _reverseOffsets[a];
+        }
+    }
+
+    uint32_t RouteGraph::airportIndex(std::string_view code) const
+    {
+        const auto it = _airportIndex.find(std::string(code));
+        return it == _airportIndex.end() ? noAirport : it->second;
+    }
+
+    RouteSearchResult RouteGraph::search(const RouteQuery& query) const
+    {
+        const uint32_t origin = airportIndex(query.origin);
+        const uint32_t destination = airportIndex(query.destination);
+        if(origin == noAirport || destination == noAirport || origin == destination || query.maxLegs == 0)
+        {
+            return {};
+        }
+
+        return Search(*this, query, origin, destination).run();
+    }
+
+    std::string RouteGraph::serialize(const RouteSearchResult& result) const
+    {
+        std::string out;
+        out.reserve(64 + result.itineraries.size() * 4 * Flight::serializedSizeHint);
+
+        JsonWriter writer(out);
+        writer.beginObject();
+        writer.field("complete", result.complete);
+        writer.key("itineraries");
+        writer.beginArray();
+        for(const Itinerary& itinerary : result.itineraries)
+        {
+            const Flight& first = _flights[itinerary.legs.front()];
+            const Flight& last = _flights[itinerary.legs.back()];
+
+            writer.beginObject();
+            writer.field("price", static_cast<double>(itinerary.priceTicks) / flightPriceScale);
+            writer.field("currency", first.currency);
+            writer.field("stops", itinerary.legs.size() - 1);
+            writer.field(getFlightFieldName(FlightField::DepartureTime), first.departureTime);
+            writer.field(getFlightFieldName(FlightField::ArrivalTime), last.arrivalTime);
+            writer.key("legs");
+            writer.beginArray();
+            for(const uint32_t leg : itinerary.legs)
+            {
+                _flights[leg].serialize(writer);
+            }
+            writer.endArray();
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+
+        return out;
+    }
+}
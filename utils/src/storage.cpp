@@ -0,0 +1,85 @@
+#include "storage.h"
+
+#include <random>
+#include <stdexcept>
+
+#include "flight-wire.h"
+#include "in-memory-storage.h"
+#include "logger.h"
+#include "mysql-provider.h"
+#include "options.h"
+
+namespace Utils
+{
+    static double generateRandomPrice(double minPrice, double maxPrice)
+    {
+        std::random_device rd; // Seed for the random number engine
+        std::mt19937 gen(rd()); // Mersenne Twister random number engine
+        std::uniform_real_distribution<double> dis(minPrice, maxPrice); // Uniform distribution in the range [minPrice, maxPrice]
+
+        return dis(gen);
+    }
+
+    static int generateRandomCabinClass()
+    {
+        std::random_device rd; // Seed for the random number engine
+        std::mt19937 gen(rd()); // Mersenne Twister random number engine
+        std::uniform_int_distribution<int> dis(0, 3); // Uniform distribution for cabin classes (0 to 3)
+
+        return dis(gen);
+    }
+
+    static int64_t generateRandomSeconds(int64_t minSeconds, int64_t maxSeconds)
+    {
+        std::random_device rd; // Seed for the random number engine
+        std::mt19937 gen(rd()); // Mersenne Twister random number engine
+        std::uniform_int_distribution<int64_t> dis(minSeconds / 300, maxSeconds / 300); // Whole five minute steps in [minSeconds, maxSeconds]
+
+        return dis(gen) * 300;
+    }
+
+    std::shared_ptr<Storage> createStorage(const Options& options)
+    {
+        const std::string backend = options.getStorageBackend();
+
+        if(backend == "mysql")
+        {
+            LOG_INFO("Using the MySQL storage backend at ", options.getMySqlHost(), ":", options.getMySqlPort());
+            return std::make_shared<MySqlProvider>(options.getMySqlHost(),
+                                                   options.getMySqlPort(),
+                                                   options.getMySqlUsername(),
+                                                   options.getMySqlPassword(),
+                                                   options.getMySqlDatabase());
+        }
+
+        if(backend == "memory")
+        {
+            LOG_INFO("Using the in-memory storage backend");
+            return std::make_shared<InMemoryStorage>();
+        }
+
+        throw std::invalid_argument("Unknown storage backend: " + backend);
+    }
+
+    Flight makeSeedFlight(const Pair& pair)
+    {
+        const double minPrice = 100.0;
+        const double maxPrice = 1000.0;
+
+        // Spread over a week, so that the cache server's itinerary search finds connections.
+        const int64_t departure = parseDateTime("2021-01-01 00:00:00") + generateRandomSeconds(0, 7 * 86400);
+        const int64_t arrival = departure + generateRandomSeconds(3600, 12 * 3600);
+
+        return Flight {
+            .origin = pair.origin,
+            .destination = pair.destination,
+            .type = pair.type ? FlightType::Roundtrip : FlightType::OneWay,
+            .departureTime = formatDateTime(departure),
+            .arrivalTime = formatDateTime(arrival),
+            .fareCarrier = pair.fareCarrier,
+            .price = generateRandomPrice(minPrice, maxPrice),
+            .currency = "USD",
+            .cabin = static_cast<CabinType>(generateRandomCabinClass())
+        };
+    }
+}
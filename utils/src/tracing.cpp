@@ -0,0 +1,237 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <unistd.h>
+
+#include "json-writer.h"
+#include "logger.h"
+
+namespace Utils
+{
+    /**
+     * The spans recorded by one thread. Only the owning thread writes, the mutex is there for
+     * the rare on-demand dump and is therefore practically never contended.
+     */
+    class Tracer::Ring
+    {
+    public:
+        Ring(size_t capacity, unsigned int threadIndex) : _events(capacity), _threadIndex(threadIndex) {}
+
+        void push(const TraceEvent& event)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _events[_head % _events.size()] = event;
+            ++_head;
+        }
+
+        /**
+         * @brief Copies the trailing run of events belonging to the given request. A request is
+         * handled by a single thread from start to end, so its spans are contiguous.
+         */
+        std::vector<TraceEvent> request(uint64_t requestId)
+        {
+            std::vector<TraceEvent> result;
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            const size_t available = std::min(_head, _events.size());
+            for(size_t i = 1; i <= available; ++i)
+            {
+                const TraceEvent& event = _events[(_head - i) % _events.size()];
+                if(event.requestId != requestId)
+                {
+                    break;
+                }
+                result.push_back(event);
+            }
+
+            return result;
+        }
+
+        std::vector<TraceEvent> all()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const size_t available = std::min(_head, _events.size());
+
+            std::vector<TraceEvent> result;
+            result.reserve(available);
+            for(size_t i = _head - available; i != _head; ++i)
+            {
+                result.push_back(_events[i % _events.size()]);
+            }
+
+            return result;
+        }
+
+        unsigned int threadIndex() const { return _threadIndex; }
+
+    private:
+        std::mutex _mutex;
+        std::vector<TraceEvent> _events;
+        size_t _head = 0;
+        const unsigned int _threadIndex;
+    };
+
+    namespace
+    {
+        constexpr size_t traceEventSizeHint = 112;
+
+        void writeThreadName(JsonWriter& writer, int pid, unsigned int threadIndex)
+        {
+            writer.beginObject();
+            writer.field("name", "thread_name");
+            writer.field("ph", "M");
+            writer.field("pid", pid);
+            writer.field("tid", threadIndex);
+            writer.key("args");
+            writer.beginObject();
+            writer.field("name", "thread-" + std::to_string(threadIndex));
+            writer.endObject();
+            writer.endObject();
+        }
+
+        void writeEvents(JsonWriter& writer, int pid, unsigned int threadIndex, const std::vector<TraceEvent>& events)
+        {
+            for(const auto& event : events)
+            {
+                writer.beginObject();
+                writer.field("name", event.name);
+                writer.field("cat", event.requestId == 0 ? "background" : "request");
+                writer.field("ph", "X");
+                writer.field("ts", static_cast<double>(event.startNanos) / 1000.0);
+                writer.field("dur", static_cast<double>(event.durationNanos) / 1000.0);
+                writer.field("pid", pid);
+                writer.field("tid", threadIndex);
+                writer.key("args");
+                writer.beginObject();
+                writer.field("request", event.requestId);
+                writer.endObject();
+                writer.endObject();
+            }
+        }
+    }
+
+    uint64_t& currentTraceRequestId()
+    {
+        thread_local uint64_t requestId = 0;
+        return requestId;
+    }
+
+    Tracer& Tracer::instance()
+    {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    void Tracer::configure(unsigned int ringSize, unsigned int sampleRate, unsigned int slowRequestMs, const std::string& outputDir)
+    {
+        _ringSize = ringSize;
+        _sampleRate = sampleRate;
+        _slowRequestNanos = static_cast<int64_t>(slowRequestMs) * 1000000;
+        _outputDir = outputDir;
+
+        if(ringSize != 0 && (sampleRate != 0 || slowRequestMs != 0))
+        {
+            std::error_code error;
+            std::filesystem::create_directories(_outputDir, error);
+            if(error)
+            {
+                LOG_WARNING("Cannot create trace directory ", _outputDir, ": ", error.message());
+            }
+        }
+
+        _enabled.store(ringSize != 0, std::memory_order_relaxed);
+    }
+
+    void Tracer::record(const TraceEvent& event)
+    {
+        localRing().push(event);
+    }
+
+    void Tracer::finishRequest(uint64_t requestId, int64_t durationNanos)
+    {
+        const bool sampled = _sampleRate != 0 && requestId % _sampleRate == 0;
+        const bool slow = _slowRequestNanos != 0 && durationNanos >= _slowRequestNanos;
+        if(!sampled && !slow)
+        {
+            return;
+        }
+
+        Ring& ring = localRing();
+        writeCapture(requestId, ring.request(requestId), ring.threadIndex());
+    }
+
+    void Tracer::writeCapture(uint64_t requestId, const std::vector<TraceEvent>& events, unsigned int threadIndex)
+    {
+        const int pid = static_cast<int>(getpid());
+
+        std::string out;
+        out.reserve(64 + events.size() * traceEventSizeHint);
+        {
+            JsonWriter writer(out);
+            writer.beginObject();
+            writer.key("traceEvents");
+            writer.beginArray();
+            writeThreadName(writer, pid, threadIndex);
+            writeEvents(writer, pid, threadIndex, events);
+            writer.endArray();
+            writer.endObject();
+        }
+
+        const std::string path = _outputDir + "/trace-" + std::to_string(requestId) + ".json";
+        FILE* file = std::fopen(path.c_str(), "w");
+        if(!file)
+        {
+            LOG_WARNING("Cannot write trace file ", path);
+            return;
+        }
+
+        std::fwrite(out.data(), 1, out.size(), file);
+        std::fclose(file);
+
+        LOG_INFO("Captured trace of request ", requestId, " to ", path);
+    }
+
+    std::string Tracer::dumpChromeTrace()
+    {
+        std::vector<std::shared_ptr<Ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            rings = _rings;
+        }
+
+        const int pid = static_cast<int>(getpid());
+
+        std::string out;
+        out.reserve(64 + rings.size() * _ringSize * traceEventSizeHint);
+
+        JsonWriter writer(out);
+        writer.beginObject();
+        writer.key("traceEvents");
+        writer.beginArray();
+        for(const auto& ring : rings)
+        {
+            writeThreadName(writer, pid, ring->threadIndex());
+            writeEvents(writer, pid, ring->threadIndex(), ring->all());
+        }
+        writer.endArray();
+        writer.field("displayTimeUnit", "ms");
+        writer.endObject();
+
+        return out;
+    }
+
+    Tracer::Ring& Tracer::localRing()
+    {
+        thread_local std::shared_ptr<Ring> ring;
+        if(!ring)
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            ring = std::make_shared<Ring>(_ringSize, _nextThreadIndex++);
+            _rings.push_back(ring);
+        }
+
+        return *ring;
+    }
+}